@@ -0,0 +1,152 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+/*
+ * Capacity search of an HttpServer behind a bottleneck link.
+ *
+ * nClients client nodes reach one HttpServer over a dumbbell topology. An
+ * HttpCapacitySearch adds usersPerStep users every stepTime seconds and
+ * stops at the first step whose 95th percentile page load time is above
+ * slo seconds. The server serves the requests with a pool of workers
+ * (workers, serviceTime), so either the server or the bottleneck link may
+ * saturate first.
+ *
+ * The load-versus-latency curve is written to http-capacity.txt.
+ *
+ * Example:
+ *   ./waf --run "http-capacity-search --bottleneckRate=50Mbps --workers=8 --serviceTime=0.005 --slo=2"
+ */
+
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/point-to-point-layout-module.h"
+#include <iostream>
+
+
+using namespace ns3;
+using namespace std;
+
+NS_LOG_COMPONENT_DEFINE ("HttpCapacitySearchExample");
+
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nClients = 10;
+  uint32_t initialUsers = 10;
+  uint32_t usersPerStep = 10;
+  double stepTime = 60.0;
+  double slo = 3.0;
+  bool ramp = false;
+  uint32_t maxSteps = 50;
+  string bottleneckRate = "100Mbps";
+  uint32_t workers = 0;
+  double serviceTime = 0.0;
+  uint32_t maxQueueLength = 0;
+  string outputFile = "http-capacity.txt";
+
+  CommandLine cmd;
+  cmd.AddValue ("nClients", "Number of client nodes the users are spread over", nClients);
+  cmd.AddValue ("initialUsers", "Number of users of the first step", initialUsers);
+  cmd.AddValue ("usersPerStep", "Number of users added at each step", usersPerStep);
+  cmd.AddValue ("stepTime", "Duration of each step in seconds", stepTime);
+  cmd.AddValue ("slo", "95th percentile page load time SLO in seconds", slo);
+  cmd.AddValue ("ramp", "Spread the new users of a step over the step", ramp);
+  cmd.AddValue ("maxSteps", "Maximum number of steps", maxSteps);
+  cmd.AddValue ("bottleneckRate", "Data rate of the bottleneck link", bottleneckRate);
+  cmd.AddValue ("workers", "Number of workers of the server (0 to answer at once)", workers);
+  cmd.AddValue ("serviceTime", "Mean service time of a request in seconds (exponential)", serviceTime);
+  cmd.AddValue ("maxQueueLength", "Maximum number of requests waiting for a worker (0 for no limit)", maxQueueLength);
+  cmd.AddValue ("outputFile", "File the load-versus-latency curve is written to", outputFile);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (nClients == 0, "At least one client node is needed.");
+
+  LogComponentEnable ("HttpCapacitySearch", LOG_LEVEL_INFO);
+
+  PointToPointHelper access;
+  access.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Gbps")));
+  access.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (1)));
+
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", DataRateValue (DataRate (bottleneckRate)));
+  bottleneck.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (20)));
+
+  PointToPointDumbbellHelper dumbbell (nClients, access, 1, access, bottleneck);
+  InternetStackHelper internetStack;
+  dumbbell.InstallStack (internetStack);
+  dumbbell.AssignIpv4Addresses (Ipv4AddressHelper ("10.0.0.0", "255.255.255.0"),
+                                Ipv4AddressHelper ("172.16.0.0", "255.255.255.0"),
+                                Ipv4AddressHelper ("192.168.0.0", "255.255.255.0"));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  NodeContainer clients;
+  for (uint32_t i = 0; i < nClients; i++)
+    {
+      clients.Add (dumbbell.GetLeft (i));
+    }
+
+  uint16_t httpServerPort = 80;
+  HttpServerHelper httpServer (httpServerPort);
+  httpServer.SetAttribute ("NumOfWorkers", UintegerValue (workers));
+  httpServer.SetAttribute ("MaxQueueLength", UintegerValue (maxQueueLength));
+  if (serviceTime > 0)
+    {
+      Ptr<ExponentialRandomVariable> service = CreateObject<ExponentialRandomVariable> ();
+      service->SetAttribute ("Mean", DoubleValue (serviceTime));
+      httpServer.SetAttribute ("ServiceTime", PointerValue (service));
+    }
+  ApplicationContainer httpServerApps = httpServer.Install (dumbbell.GetRight (0));
+  httpServerApps.Start (Seconds (0.0));
+
+  //The users are installed by the search, step after step.
+  HttpClientHelper httpClient (dumbbell.GetRightIpv4Address (0), httpServerPort);
+
+  Ptr<HttpCapacitySearch> search = CreateObject<HttpCapacitySearch> ();
+  search->SetAttribute ("InitialUsers", UintegerValue (initialUsers));
+  search->SetAttribute ("UsersPerStep", UintegerValue (usersPerStep));
+  search->SetAttribute ("StepDuration", TimeValue (Seconds (stepTime)));
+  search->SetAttribute ("Slo", TimeValue (Seconds (slo)));
+  search->SetAttribute ("Ramp", BooleanValue (ramp));
+  search->SetAttribute ("MaxSteps", UintegerValue (maxSteps));
+  search->SetAttribute ("OutputFile", StringValue (outputFile));
+  Simulator::Schedule (Seconds (1.0), &HttpCapacitySearch::Start, search, httpClient, clients);
+
+  Simulator::Run ();
+
+  cout << "users pages/s p95(s)" << endl;
+  const vector<HttpCapacitySearch::Point> &curve = search->GetCurve ();
+  for (vector<HttpCapacitySearch::Point>::const_iterator it = curve.begin (); it != curve.end (); ++it)
+    {
+      cout << it->users << " " << it->pagesPerSecond << " " << it->percentile.GetSeconds () << endl;
+    }
+  if (search->IsSaturated ())
+    {
+      cout << "Capacity: " << search->GetCapacity () << " users within a " << slo << " s SLO." << endl;
+    }
+  else
+    {
+      cout << "SLO not broken after " << curve.size () << " steps." << endl;
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
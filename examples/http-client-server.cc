@@ -47,10 +47,33 @@ NS_LOG_COMPONENT_DEFINE ("HttpClientServerExample");
 int
 main (int argc, char *argv[])
 {
+  string traceFile;
+  uint32_t catalogSize = 0;
+  bool multiplexing = false;
+  double arrivalRate = 0;
+  string eventLogFile;
+  uint32_t arenaPages = 0;
+  double precision = 0;
+  bool verbose = true;
+
+  CommandLine cmd;
+  cmd.AddValue ("trace", "Workload trace to replay (see http-trace-converter)", traceFile);
+  cmd.AddValue ("catalogSize", "Number of pages of the site catalog (0 to disable)", catalogSize);
+  cmd.AddValue ("multiplexing", "Fetch the objects over one multiplexed connection (HTTP/2-style)", multiplexing);
+  cmd.AddValue ("arrivalRate", "Open-loop Poisson page arrivals per second (0 for a closed-loop user)", arrivalRate);
+  cmd.AddValue ("arena", "Number of pages sampled up front and replayed (0 to sample live)", arenaPages);
+  cmd.AddValue ("precision", "Stop once the page load time is known to this relative precision (0 to run until the end)", precision);
+  cmd.AddValue ("eventLog", "Binary event file of the client (see http-event-decoder)", eventLogFile);
+  cmd.AddValue ("verbose", "Enable the log output of the applications", verbose);
+  cmd.Parse (argc, argv);
+
   //Enabling logging
-  LogComponentEnable ("HttpClientServerExample", LOG_LEVEL_INFO);
-  LogComponentEnable ("HttpClientApplication", LOG_LEVEL_INFO);
-  LogComponentEnable ("HttpServerApplication", LOG_LEVEL_INFO);
+  if (verbose)
+    {
+      LogComponentEnable ("HttpClientServerExample", LOG_LEVEL_INFO);
+      LogComponentEnable ("HttpClientApplication", LOG_LEVEL_INFO);
+      LogComponentEnable ("HttpServerApplication", LOG_LEVEL_INFO);
+    }
 
 
   NS_LOG_INFO ("Creating nodes...");
@@ -80,11 +103,60 @@ main (int argc, char *argv[])
   ApplicationContainer httpClientApps;
 
   HttpServerHelper httpServer (httpServerPort);
-  httpServerApps.Add (httpServer.Install (n.Get (0)));
-
   HttpClientHelper httpClient (i.GetAddress (0), httpServerPort);
+
+  //The client picks the pages of the catalog by Zipf popularity.
+  httpServer.SetAttribute ("CatalogSize", UintegerValue (catalogSize));
+  httpClient.SetAttribute ("CatalogSize", UintegerValue (catalogSize));
+
+  //Both sides must speak the same transport.
+  httpServer.SetAttribute ("Multiplexing", BooleanValue (multiplexing));
+  httpClient.SetAttribute ("Multiplexing", BooleanValue (multiplexing));
+
+  if (arrivalRate > 0)
+    {
+      //Pages start at Poisson arrivals, whether or not the previous ones have loaded.
+      Ptr<ExponentialRandomVariable> interArrival = CreateObject<ExponentialRandomVariable> ();
+      interArrival->SetAttribute ("Mean", DoubleValue (1.0 / arrivalRate));
+      httpClient.SetAttribute ("PageInterArrivalTime", PointerValue (interArrival));
+    }
+
+  if (!traceFile.empty ())
+    {
+      //Both sides share the memory-mapped trace.
+      Ptr<HttpWorkloadTrace> trace = CreateObject<HttpWorkloadTrace> ();
+      trace->Open (traceFile);
+      httpServer.SetAttribute ("WorkloadTrace", PointerValue (trace));
+      httpClient.SetAttribute ("WorkloadTrace", PointerValue (trace));
+    }
+
+  if (traceFile.empty () && arenaPages > 0)
+    {
+      //The workload is sampled once, before the simulation, and replayed by both sides.
+      Ptr<HttpWorkloadArena> arena = CreateObject<HttpWorkloadArena> ();
+      arena->SetAttribute ("NumOfPages", UintegerValue (arenaPages));
+      arena->AssignStreams (100);
+      arena->Generate ();
+      httpServer.SetAttribute ("WorkloadTrace", PointerValue (arena));
+      httpClient.SetAttribute ("WorkloadTrace", PointerValue (arena));
+    }
+
+  if (!eventLogFile.empty ())
+    {
+      //Events are buffered in memory and written in large blocks.
+      Ptr<HttpEventLog> eventLog = CreateObject<HttpEventLog> ();
+      eventLog->SetAttribute ("FileName", StringValue (eventLogFile));
+      httpClient.SetAttribute ("EventLog", PointerValue (eventLog));
+    }
+
+  httpServerApps.Add (httpServer.Install (n.Get (0)));
   httpClientApps.Add (httpClient.Install (n.Get (1)));
 
+  //Fixing the random variable streams makes every run reproducible.
+  int64_t stream = 1;
+  stream += httpServer.AssignStreams (n.Get (0), stream);
+  stream += httpClient.AssignStreams (n.Get (1), stream);
+
 
   httpServerApps.Start (Seconds(1.0));
   httpServerApps.Stop (Seconds(10.0));
@@ -92,12 +164,33 @@ main (int argc, char *argv[])
   httpClientApps.Start (Seconds(2.0));
   httpClientApps.Stop (Seconds(10.0));
 
+  //Page load time, time to first byte and object download time percentiles
+  //are written to http-stats.txt when the simulation is destroyed.
+  Ptr<HttpStatsCollector> httpStats = CreateObject<HttpStatsCollector> ();
+  httpStats->Install (httpClientApps);
+
+
+  //With --precision the run ends as soon as the mean page load time is
+  //precise enough; the stop time below is only an upper bound.
+  Ptr<HttpEarlyStopController> earlyStop;
+  if (precision > 0)
+    {
+      earlyStop = CreateObject<HttpEarlyStopController> ();
+      earlyStop->SetAttribute ("RelativePrecision", DoubleValue (precision));
+      earlyStop->Install (httpClientApps);
+    }
 
   Simulator::Stop(Seconds(10.0));
 
 
   NS_LOG_INFO("Starting Simulation...");
   Simulator::Run();
+  if (earlyStop != 0)
+    {
+      cout << "Mean page load time " << earlyStop->GetMean ().GetSeconds () << " s +- "
+           << earlyStop->GetRelativeHalfWidth () * 100 << "% after " << earlyStop->GetSampleCount ()
+           << " pages" << (earlyStop->IsConverged () ? "" : " (precision not reached)") << endl;
+    }
   Simulator::Destroy();
   NS_LOG_INFO("\ndone!");
   return 0;
@@ -0,0 +1,59 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+/*
+ * Decodes a binary event file written by an HttpEventLog (see the
+ * HttpClient EventLog attribute) to CSV, one line per event:
+ *
+ *   time_ns,node,session,page,connection,event,value
+ *
+ * Example:
+ *   ./waf --run "http-client-server --eventLog=http-events.bin"
+ *   ./waf --run "http-event-decoder --events=http-events.bin --csv=http-events.csv"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include <iostream>
+
+
+using namespace ns3;
+using namespace std;
+
+NS_LOG_COMPONENT_DEFINE ("HttpEventDecoder");
+
+
+int
+main (int argc, char *argv[])
+{
+  string eventFile;
+  string csvFile;
+
+  CommandLine cmd;
+  cmd.AddValue ("events", "Binary event file to decode", eventFile);
+  cmd.AddValue ("csv", "CSV file to write", csvFile);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (eventFile.empty () || csvFile.empty (), "Both --events and --csv are needed.");
+
+  uint64_t events = HttpEventLog::DecodeToCsv (eventFile, csvFile);
+
+  cout << events << " events written to " << csvFile << endl;
+  return 0;
+}
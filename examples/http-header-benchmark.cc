@@ -0,0 +1,275 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+/*
+ * Microbenchmark of the HttpHeader.
+ *
+ * Times Serialize, Deserialize, GetSerializedSize, GetHeaderField and a
+ * Packet AddHeader/RemoveHeader round trip on a request header and on
+ * response headers with a growing number of extra fields (requests only
+ * carry the request line on the wire). For every operation it reports the
+ * mean time (ns/op) and the number of heap allocations per operation, so
+ * changes to the header can be judged by numbers.
+ *
+ * Example:
+ *   ./waf --run "http-header-benchmark --iterations=1000000"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/http-header.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+
+using namespace ns3;
+using namespace std;
+
+NS_LOG_COMPONENT_DEFINE ("HttpHeaderBenchmark");
+
+
+/**
+ * \brief Number of heap allocations done by the process so far.
+ */
+static uint64_t g_allocations = 0;
+
+void *
+operator new (std::size_t size)
+{
+  g_allocations++;
+  void *p = std::malloc (size ? size : 1);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) noexcept
+{
+  std::free (p);
+}
+
+
+/**
+ * \brief State shared by the operations of a benchmark case.
+ */
+struct BenchmarkContext
+{
+  HttpHeader header;       //!< Header to serialize.
+  Buffer buffer;           //!< Header serialized.
+  HttpHeader scratch;      //!< Header to deserialize into.
+  string knownName;        //!< Known field looked up by GetHeaderField.
+  string otherName;        //!< Other field looked up by GetHeaderField.
+};
+
+/**
+ * \brief One benchmarked operation.
+ * \param ctx state of the benchmark case.
+ * \return a value that depends on the work done, so it is not optimized away.
+ */
+typedef uint32_t (* Operation)(BenchmarkContext &ctx);
+
+static uint32_t
+SerializeOp (BenchmarkContext &ctx)
+{
+  ctx.header.Serialize (ctx.buffer.Begin ());
+  return ctx.buffer.GetSize ();
+}
+
+static uint32_t
+DeserializeOp (BenchmarkContext &ctx)
+{
+  return ctx.scratch.Deserialize (ctx.buffer.Begin ());
+}
+
+static uint32_t
+GetSerializedSizeOp (BenchmarkContext &ctx)
+{
+  return ctx.header.GetSerializedSize ();
+}
+
+static uint32_t
+GetKnownFieldOp (BenchmarkContext &ctx)
+{
+  uint32_t size = ctx.header.GetHeaderField (ctx.knownName).size ();
+  NS_ABORT_MSG_IF (size == 0, "HttpHeaderBenchmark >> Known field " << ctx.knownName << " not found.");
+  return size;
+}
+
+static uint32_t
+GetOtherFieldOp (BenchmarkContext &ctx)
+{
+  return ctx.header.GetHeaderField (ctx.otherName).size ();
+}
+
+static uint32_t
+PacketRoundTripOp (BenchmarkContext &ctx)
+{
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (ctx.header);
+  packet->RemoveHeader (ctx.scratch);
+  return packet->GetSize ();
+}
+
+
+/**
+ * \brief Time an operation and print one line of results.
+ * \param caseName name of the benchmark case.
+ * \param opName name of the operation.
+ * \param op the operation.
+ * \param ctx state of the benchmark case.
+ * \param iterations number of times the operation is run.
+ */
+static void
+Run (const string &caseName, const string &opName, Operation op, BenchmarkContext &ctx, uint32_t iterations)
+{
+  // Warming up caches and any lazily allocated state.
+  uint64_t sink = 0;
+  for (uint32_t i = 0; i < iterations / 10 + 1; i++)
+    {
+      sink += op (ctx);
+    }
+
+  uint64_t allocations = g_allocations;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      sink += op (ctx);
+    }
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now ();
+  allocations = g_allocations - allocations;
+
+  double ns = std::chrono::duration_cast<std::chrono::nanoseconds> (end - start).count ();
+  cout << left << setw (28) << caseName << setw (20) << opName << right
+       << fixed << setprecision (1) << setw (12) << ns / iterations
+       << setprecision (2) << setw (12) << static_cast<double> (allocations) / iterations
+       << "   (" << sink % 10 << ")" << endl;
+}
+
+/**
+ * \brief Run every operation on a header.
+ * \param caseName name of the benchmark case.
+ * \param header the header.
+ * \param knownName known field looked up by GetHeaderField, or empty.
+ * \param otherName other field looked up by GetHeaderField, or empty.
+ * \param iterations number of times each operation is run.
+ */
+static void
+RunCase (const string &caseName, const HttpHeader &header,
+         const string &knownName, const string &otherName, uint32_t iterations)
+{
+  BenchmarkContext ctx;
+  ctx.header = header;
+  ctx.buffer.AddAtStart (header.GetSerializedSize ());
+  header.Serialize (ctx.buffer.Begin ());
+  ctx.knownName = knownName;
+  ctx.otherName = otherName;
+
+  Run (caseName, "Serialize", &SerializeOp, ctx, iterations);
+  Run (caseName, "Deserialize", &DeserializeOp, ctx, iterations);
+  Run (caseName, "GetSerializedSize", &GetSerializedSizeOp, ctx, iterations);
+  if (!knownName.empty ())
+    {
+      Run (caseName, "GetHeaderField known", &GetKnownFieldOp, ctx, iterations);
+    }
+  if (!otherName.empty ())
+    {
+      // The last field added, so every other field is compared first.
+      Run (caseName, "GetHeaderField other", &GetOtherFieldOp, ctx, iterations);
+    }
+  Run (caseName, "Packet round trip", &PacketRoundTripOp, ctx, iterations);
+}
+
+/**
+ * \brief Add browser-like extra fields to a header.
+ * \param header the header.
+ * \param numFields number of fields to add.
+ * \return name of the last field added, or an empty string.
+ */
+static string
+AddExtraFields (HttpHeader &header, uint32_t numFields)
+{
+  static const char *names[] = { "Host", "User-Agent", "Accept", "Accept-Language",
+                                 "Accept-Encoding", "Connection", "Cache-Control", "Cookie" };
+  static const char *values[] = { "www.example.com",
+                                  "Mozilla/5.0 (X11; Linux x86_64) Gecko/20100101 Firefox/68.0",
+                                  "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8",
+                                  "en-US,en;q=0.5", "gzip, deflate", "keep-alive", "max-age=0",
+                                  "session=5f2b8c1d9e7a4f6b; theme=dark; lang=en" };
+  string last;
+  for (uint32_t i = 0; i < numFields; i++)
+    {
+      std::ostringstream name;
+      name << names[i % 8];
+      if (i >= 8)
+        {
+          name << "-" << i / 8;
+        }
+      last = name.str ();
+      header.SetHeaderField (last, values[i % 8]);
+    }
+  return last;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t iterations = 200000;
+
+  CommandLine cmd;
+  cmd.AddValue ("iterations", "Number of times each operation is run", iterations);
+  cmd.Parse (argc, argv);
+
+  cout << left << setw (28) << "case" << setw (20) << "operation" << right
+       << setw (12) << "ns/op" << setw (12) << "allocs/op" << endl;
+
+  HttpHeader request;
+  request.SetRequest (true);
+  request.SetMethod ("GET");
+  request.SetUrl ("main/object");
+  request.SetVersion ("HTTP/1.1");
+  RunCase ("request", request, "", "", iterations);
+
+  uint32_t extraFields[] = { 0, 4, 16 };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      HttpHeader response;
+      response.SetRequest (false);
+      response.SetVersion ("HTTP/1.1");
+      response.SetStatusCode ("200");
+      response.SetPhrase ("OK");
+      response.SetContentLength (19104);
+      response.SetContentType (HttpHeader::MAIN_OBJECT);
+      response.SetNumOfInlineObjects (31);
+      string otherName = AddExtraFields (response, extraFields[i]);
+
+      std::ostringstream caseName;
+      caseName << "response, " << 3 + extraFields[i] << " fields";
+      RunCase (caseName.str (), response, "ContentLength", otherName, iterations);
+    }
+
+  return 0;
+}
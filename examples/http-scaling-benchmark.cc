@@ -0,0 +1,210 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+/*
+ * Scaling benchmark of the HTTP Traffic Generator.
+ *
+ * Thousands of HttpClient nodes fetch web pages from a few HttpServer nodes
+ * over a star topology (every node is a spoke of a single hub) or a dumbbell
+ * topology (clients on the left, servers on the right of a bottleneck link).
+ * Client i is served by server i % nServers. Each client node runs
+ * usersPerNode user sessions in a single HttpClient application.
+ *
+ * At the end the program reports:
+ *  - setup time (building the topology, routing and applications) and run
+ *    time, in wall-clock seconds;
+ *  - simulated pages per second, summed over all clients;
+ *  - simulator events processed per wall-clock second of the run;
+ *  - peak resident set size of the process.
+ *
+ * Example:
+ *   ./waf --run "http-scaling-benchmark --nClients=5000 --nServers=8 --topology=dumbbell"
+ */
+
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/point-to-point-layout-module.h"
+#include <sys/resource.h>
+#include <iostream>
+
+
+using namespace ns3;
+using namespace std;
+
+NS_LOG_COMPONENT_DEFINE ("HttpScalingBenchmark");
+
+
+/**
+ * \brief Get the peak resident set size of the process.
+ * \return peak RSS in kilobytes.
+ */
+static long
+GetPeakRssKb (void)
+{
+  struct rusage usage;
+  if (getrusage (RUSAGE_SELF, &usage) != 0)
+    {
+      return 0;
+    }
+  return usage.ru_maxrss;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nClients = 1000;
+  uint32_t nServers = 4;
+  uint32_t usersPerNode = 1;
+  string topology = "star";
+  double simTime = 60.0;
+  uint32_t pipelineDepth = 1;
+  uint32_t maxConnections = 1;
+  string accessRate = "100Mbps";
+  string bottleneckRate = "10Gbps";
+  string statsFile = "http-scaling-benchmark.txt";
+
+  CommandLine cmd;
+  cmd.AddValue ("nClients", "Number of client nodes", nClients);
+  cmd.AddValue ("nServers", "Number of server nodes", nServers);
+  cmd.AddValue ("usersPerNode", "Number of user sessions on each client node", usersPerNode);
+  cmd.AddValue ("topology", "Topology: star or dumbbell", topology);
+  cmd.AddValue ("simTime", "Simulated time in seconds", simTime);
+  cmd.AddValue ("pipelineDepth", "PipelineDepth of the clients", pipelineDepth);
+  cmd.AddValue ("maxConnections", "MaxConnectionsPerServer of the clients", maxConnections);
+  cmd.AddValue ("accessRate", "Data rate of the access links", accessRate);
+  cmd.AddValue ("bottleneckRate", "Data rate of the dumbbell bottleneck link", bottleneckRate);
+  cmd.AddValue ("statsFile", "File the latency percentiles are written to", statsFile);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (nClients == 0 || nServers == 0, "At least one client and one server are needed.");
+  NS_ABORT_MSG_IF (topology != "star" && topology != "dumbbell", "Unknown topology " << topology);
+
+  SystemWallClockMs setupClock;
+  setupClock.Start ();
+
+  PointToPointHelper access;
+  access.SetDeviceAttribute ("DataRate", DataRateValue (DataRate (accessRate)));
+  access.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (1)));
+
+  InternetStackHelper internetStack;
+  NodeContainer clients;
+  NodeContainer servers;
+  vector<Ipv4Address> serverAddresses;
+
+  if (topology == "star")
+    {
+      // Spokes 0 to nServers-1 are the servers, the others are the clients.
+      PointToPointStarHelper star (nServers + nClients, access);
+      star.InstallStack (internetStack);
+      star.AssignIpv4Addresses (Ipv4AddressHelper ("10.0.0.0", "255.255.255.0"));
+
+      for (uint32_t i = 0; i < nServers; i++)
+        {
+          servers.Add (star.GetSpokeNode (i));
+          serverAddresses.push_back (star.GetSpokeIpv4Address (i));
+        }
+      for (uint32_t i = 0; i < nClients; i++)
+        {
+          clients.Add (star.GetSpokeNode (nServers + i));
+        }
+    }
+  else
+    {
+      PointToPointHelper bottleneck;
+      bottleneck.SetDeviceAttribute ("DataRate", DataRateValue (DataRate (bottleneckRate)));
+      bottleneck.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (10)));
+
+      PointToPointDumbbellHelper dumbbell (nClients, access, nServers, access, bottleneck);
+      dumbbell.InstallStack (internetStack);
+      // Separate address ranges, so thousands of /24 leaf networks never overlap.
+      dumbbell.AssignIpv4Addresses (Ipv4AddressHelper ("10.0.0.0", "255.255.255.0"),
+                                    Ipv4AddressHelper ("172.16.0.0", "255.255.255.0"),
+                                    Ipv4AddressHelper ("192.168.0.0", "255.255.255.0"));
+
+      for (uint32_t i = 0; i < nServers; i++)
+        {
+          servers.Add (dumbbell.GetRight (i));
+          serverAddresses.push_back (dumbbell.GetRightIpv4Address (i));
+        }
+      for (uint32_t i = 0; i < nClients; i++)
+        {
+          clients.Add (dumbbell.GetLeft (i));
+        }
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  uint16_t httpServerPort = 80;
+  HttpServerHelper httpServer (httpServerPort);
+  ApplicationContainer httpServerApps = httpServer.Install (servers);
+  httpServerApps.Start (Seconds (0.0));
+  httpServerApps.Stop (Seconds (simTime));
+
+  ApplicationContainer httpClientApps;
+  for (uint32_t i = 0; i < nClients; i++)
+    {
+      HttpClientHelper httpClient (serverAddresses[i % nServers], httpServerPort);
+      httpClient.SetAttribute ("PipelineDepth", UintegerValue (pipelineDepth));
+      httpClient.SetAttribute ("MaxConnectionsPerServer", UintegerValue (maxConnections));
+      httpClient.SetAttribute ("UserStartWindow", TimeValue (Seconds (1.0)));
+      httpClientApps.Add (httpClient.Install (NodeContainer (clients.Get (i)), usersPerNode));
+    }
+
+  //Spreading the first requests over the first second, so the clients are not synchronized.
+  Ptr<UniformRandomVariable> startTime = CreateObject<UniformRandomVariable> ();
+  startTime->SetAttribute ("Min", DoubleValue (0.1));
+  startTime->SetAttribute ("Max", DoubleValue (1.1));
+  for (uint32_t i = 0; i < httpClientApps.GetN (); i++)
+    {
+      httpClientApps.Get (i)->SetStartTime (Seconds (startTime->GetValue ()));
+      httpClientApps.Get (i)->SetStopTime (Seconds (simTime));
+    }
+
+  Ptr<HttpStatsCollector> httpStats = CreateObject<HttpStatsCollector> ();
+  httpStats->SetAttribute ("OutputFile", StringValue (statsFile));
+  httpStats->Install (httpClientApps);
+
+  Simulator::Stop (Seconds (simTime));
+
+  double setupSeconds = setupClock.End () / 1000.0;
+
+  SystemWallClockMs runClock;
+  runClock.Start ();
+  Simulator::Run ();
+  double runSeconds = runClock.End () / 1000.0;
+
+  uint64_t events = Simulator::GetEventCount ();
+  uint64_t pages = httpStats->GetPagesLoaded ();
+
+  cout << "topology            " << topology << " (" << nClients << " clients x "
+       << usersPerNode << " users, " << nServers << " servers)" << endl;
+  cout << "setup time          " << setupSeconds << " s" << endl;
+  cout << "run time            " << runSeconds << " s" << endl;
+  cout << "pages loaded        " << pages << endl;
+  cout << "simulated pages/s   " << pages / simTime << endl;
+  cout << "events              " << events << endl;
+  cout << "events/wall-clock s " << (runSeconds > 0 ? events / runSeconds : 0) << endl;
+  cout << "peak RSS            " << GetPeakRssKb () / 1024.0 << " MB" << endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
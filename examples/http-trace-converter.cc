@@ -0,0 +1,71 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+/*
+ * Converts a CSV workload to the binary trace format replayed by the
+ * HttpServer and HttpClient WorkloadTrace attributes (see HttpWorkloadTrace).
+ * Each CSV line describes one page:
+ *
+ *   reading time (s),main object size,inline object size,inline object size,...
+ *
+ * Empty lines and lines starting with '#' are skipped.
+ *
+ * Example:
+ *   ./waf --run "http-trace-converter --csv=pages.csv --trace=pages.trace"
+ *   ./waf --run "http-client-server --trace=pages.trace"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include <iostream>
+
+
+using namespace ns3;
+using namespace std;
+
+NS_LOG_COMPONENT_DEFINE ("HttpTraceConverter");
+
+
+int
+main (int argc, char *argv[])
+{
+  string csvFile;
+  string traceFile;
+
+  CommandLine cmd;
+  cmd.AddValue ("csv", "CSV workload to convert", csvFile);
+  cmd.AddValue ("trace", "Binary trace to write", traceFile);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (csvFile.empty () || traceFile.empty (), "Both --csv and --trace are needed.");
+
+  uint64_t pages = HttpWorkloadTrace::ConvertFromCsv (csvFile, traceFile);
+
+  // Reading the trace back checks it and reports its contents.
+  Ptr<HttpWorkloadTrace> trace = CreateObject<HttpWorkloadTrace> ();
+  trace->Open (traceFile);
+  uint64_t objects = 0;
+  for (uint64_t page = 0; page < trace->GetNumPages (); page++)
+    {
+      objects += 1 + trace->GetNumOfInlineObjects (page);
+    }
+
+  cout << pages << " pages and " << objects << " objects written to " << traceFile << endl;
+  return 0;
+}
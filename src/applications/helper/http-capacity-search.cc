@@ -0,0 +1,314 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "http-capacity-search.h"
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HttpCapacitySearch");
+
+NS_OBJECT_ENSURE_REGISTERED (HttpCapacitySearch);
+
+TypeId
+HttpCapacitySearch::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HttpCapacitySearch")
+    .SetParent<Object> ()
+    .AddConstructor<HttpCapacitySearch> ()
+    .AddAttribute ("InitialUsers",
+                   "Number of users of the first step.",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&HttpCapacitySearch::m_initialUsers),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("UsersPerStep",
+                   "Number of users added at each following step.",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&HttpCapacitySearch::m_usersPerStep),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("StepDuration",
+                   "Duration of each load step.",
+                   TimeValue (Seconds (60)),
+                   MakeTimeAccessor (&HttpCapacitySearch::m_stepDuration),
+                   MakeTimeChecker ())
+    .AddAttribute ("SettlingTime",
+                   "Start of each step whose page loads are not measured, while the new "
+                   "users settle.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&HttpCapacitySearch::m_settlingTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("Ramp",
+                   "Spread the start of the users added by a step over the step, instead "
+                   "of starting them all at once.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&HttpCapacitySearch::m_ramp),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxSteps",
+                   "Maximum number of steps.",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&HttpCapacitySearch::m_maxSteps),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Slo",
+                   "Page load time SLO.",
+                   TimeValue (Seconds (3)),
+                   MakeTimeAccessor (&HttpCapacitySearch::m_slo),
+                   MakeTimeChecker ())
+    .AddAttribute ("Percentile",
+                   "Percentile of the page load time compared with the Slo.",
+                   DoubleValue (95),
+                   MakeDoubleAccessor (&HttpCapacitySearch::m_percentile),
+                   MakeDoubleChecker<double> (0, 100))
+    .AddAttribute ("OutputFile",
+                   "Name of the file the load-versus-latency curve is written to. "
+                   "An empty name disables the output.",
+                   StringValue ("http-capacity.txt"),
+                   MakeStringAccessor (&HttpCapacitySearch::m_outputFile),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+HttpCapacitySearch::HttpCapacitySearch ()
+  : m_helper (Address (), 80),
+    m_nextNode (0),
+    m_users (0),
+    m_stepFailures (0),
+    m_saturated (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HttpCapacitySearch::~HttpCapacitySearch ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HttpCapacitySearch::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nodes = NodeContainer ();
+  m_clients = ApplicationContainer ();
+  m_curve.clear ();
+  Object::DoDispose ();
+}
+
+void
+HttpCapacitySearch::Start (const HttpClientHelper &helper, NodeContainer nodes)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (nodes.GetN () > 0, "HttpCapacitySearch >> No client nodes.");
+
+  m_helper = helper;
+  m_nodes = nodes;
+  if (m_ramp)
+    {
+      m_helper.SetAttribute ("UserStartWindow", TimeValue (m_stepDuration));
+    }
+  Simulator::ScheduleNow (&HttpCapacitySearch::Step, this);
+}
+
+const std::vector<HttpCapacitySearch::Point> &
+HttpCapacitySearch::GetCurve (void) const
+{
+  return m_curve;
+}
+
+uint32_t
+HttpCapacitySearch::GetCapacity (void) const
+{
+  uint32_t capacity = 0;
+  for (std::vector<Point>::const_iterator it = m_curve.begin (); it != m_curve.end (); ++it)
+    {
+      if (it->withinSlo)
+        {
+          capacity = it->users;
+        }
+    }
+  return capacity;
+}
+
+bool
+HttpCapacitySearch::IsSaturated (void) const
+{
+  return m_saturated;
+}
+
+void
+HttpCapacitySearch::Step (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_users > 0)
+    {
+      if (EndStep ())
+        {
+          NS_LOG_INFO ("HttpCapacitySearch >> SLO broken with " << m_users << " users. Capacity: "
+                       << GetCapacity () << " users.");
+          Simulator::Stop ();
+          return;
+        }
+      if (m_curve.size () == m_maxSteps)
+        {
+          NS_LOG_INFO ("HttpCapacitySearch >> SLO still met with " << m_users << " users after "
+                       << m_maxSteps << " steps.");
+          Simulator::Stop ();
+          return;
+        }
+    }
+
+  AddUsers (m_users == 0 ? m_initialUsers : m_usersPerStep);
+  m_stepStart = Simulator::Now ();
+  m_stepHistogram.Reset ();
+  m_stepFailures = 0;
+  Simulator::Schedule (m_stepDuration, &HttpCapacitySearch::Step, this);
+}
+
+void
+HttpCapacitySearch::AddUsers (uint32_t users)
+{
+  NS_LOG_FUNCTION (this << users);
+
+  // One application per node, the remainder going round robin to the next nodes.
+  uint32_t numNodes = m_nodes.GetN ();
+  for (uint32_t i = 0; i < std::min (users, numNodes); i++)
+    {
+      uint32_t share = users / numNodes + (i < users % numNodes ? 1 : 0);
+      Ptr<Node> node = m_nodes.Get (m_nextNode);
+      m_nextNode = (m_nextNode + 1) % numNodes;
+
+      ApplicationContainer apps = m_helper.Install (NodeContainer (node), share);
+      for (ApplicationContainer::Iterator it = apps.Begin (); it != apps.End (); ++it)
+        {
+          (*it)->TraceConnectWithoutContext ("PageLoaded", MakeCallback (&HttpCapacitySearch::PageLoaded, this));
+          (*it)->TraceConnectWithoutContext ("PageFailed", MakeCallback (&HttpCapacitySearch::PageFailed, this));
+        }
+      apps.Start (Seconds (0));
+      m_clients.Add (apps);
+    }
+  m_users += users;
+  NS_LOG_INFO ("HttpCapacitySearch >> " << m_users << " users.");
+}
+
+void
+HttpCapacitySearch::PageLoaded (uint32_t pageId, uint32_t numOfInlineObjects, Time delay, uint32_t size)
+{
+  if (Simulator::Now () >= m_stepStart + m_settlingTime)
+    {
+      m_stepHistogram.Record (delay);
+    }
+}
+
+void
+HttpCapacitySearch::PageFailed (uint32_t pageId, uint32_t numOfInlineObjects, Time delay)
+{
+  if (Simulator::Now () >= m_stepStart + m_settlingTime)
+    {
+      m_stepFailures++;
+    }
+}
+
+bool
+HttpCapacitySearch::EndStep (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Point point;
+  point.users = m_users;
+  point.pages = m_stepHistogram.GetCount ();
+  Time measured = m_stepDuration - m_settlingTime;
+  point.pagesPerSecond = measured.IsStrictlyPositive () ? point.pages / measured.GetSeconds () : 0;
+  point.mean = m_stepHistogram.GetMean ();
+  point.failed = m_stepFailures;
+
+  // The slowest pages are often still loading at the end of the step. They
+  // are counted with their age, a lower bound of their load time, so they
+  // do not drop out of the percentile.
+  HttpLatencyHistogram histogram = m_stepHistogram;
+  point.outstanding = 0;
+  for (ApplicationContainer::Iterator it = m_clients.Begin (); it != m_clients.End (); ++it)
+    {
+      std::vector<Time> ages = DynamicCast<HttpClient> (*it)->GetLoadingPageAges ();
+      for (uint32_t i = 0; i < ages.size (); i++)
+        {
+          histogram.Record (ages[i]);
+        }
+      point.outstanding += ages.size ();
+    }
+
+  // Failed pages never loaded, they rank above every page load time. The
+  // percentile of all the pages is then a higher percentile of the others,
+  // or beyond them.
+  uint64_t timed = point.pages + point.outstanding;
+  uint64_t total = timed + point.failed;
+  uint64_t rank = std::ceil (m_percentile / 100 * total);
+  point.percentile = rank <= timed ? histogram.GetPercentile (m_percentile * total / timed)
+                                   : Time::Max ();
+  // With users and no page loaded, every page outlasted the step: the
+  // server is past saturation, not idle.
+  point.withinSlo = point.pages + point.failed > 0 ? point.percentile <= m_slo : m_users == 0;
+  m_curve.push_back (point);
+
+  NS_LOG_INFO ("HttpCapacitySearch >> " << point.users << " users: " << point.pages << " pages, p"
+               << m_percentile << " page load time " << point.percentile.GetSeconds () << " s.");
+  WriteCurve ();
+
+  m_saturated = !point.withinSlo;
+  return m_saturated;
+}
+
+void
+HttpCapacitySearch::WriteCurve (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_outputFile.empty ())
+    {
+      return;
+    }
+
+  std::ofstream out (m_outputFile.c_str ());
+  if (!out.is_open ())
+    {
+      NS_LOG_ERROR ("HttpCapacitySearch >> Can't open file " << m_outputFile);
+      return;
+    }
+
+  out << "# slo(s) " << m_slo.GetSeconds () << " percentile " << m_percentile
+      << " capacity(users) " << GetCapacity () << std::endl;
+  out << "# users pages outstanding failed pages/s mean(s) p" << m_percentile << "(s) within-slo" << std::endl;
+  out << std::fixed << std::setprecision (6);
+  for (std::vector<Point>::const_iterator it = m_curve.begin (); it != m_curve.end (); ++it)
+    {
+      out << it->users << " " << it->pages << " " << it->outstanding << " " << it->failed << " " << it->pagesPerSecond
+          << " " << it->mean.GetSeconds () << " " << it->percentile.GetSeconds ()
+          << " " << (it->withinSlo ? 1 : 0) << std::endl;
+    }
+}
+
+}
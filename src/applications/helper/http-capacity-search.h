@@ -0,0 +1,192 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#ifndef HTTP_CAPACITY_SEARCH_H_
+#define HTTP_CAPACITY_SEARCH_H_
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/node-container.h"
+#include "ns3/http-client-server-helper.h"
+#include "ns3/http-latency-histogram.h"
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup http
+ *
+ * Finds the load at which the page load time breaks a latency SLO, in a
+ * single run. Every StepDuration the search installs UsersPerStep more
+ * HttpClient users with an HttpClientHelper, at once or ramped over the
+ * step, spread round robin over the client nodes. At the end of each step
+ * the Percentile of the page load times of the pages loaded during the
+ * step is compared with the Slo. Pages still loading at the end of the
+ * step count with their age, a lower bound of their load time, so the
+ * slowest pages near saturation are not left out. The search stops the
+ * simulation at the first step above the Slo, or after MaxSteps steps.
+ *
+ * Each step adds a point to the load-versus-latency curve, which is
+ * written to OutputFile as the search goes. A step with users but without
+ * any page load breaks the SLO: every page took longer than the step.
+ * Failed pages, e.g. answered 503 by a full server queue, count as
+ * slower than any loaded page.
+ *
+ * Typical use:
+ * \code
+ *   Ptr<HttpCapacitySearch> search = CreateObject<HttpCapacitySearch> ();
+ *   search->SetAttribute ("Slo", TimeValue (Seconds (2)));
+ *   search->Start (httpClientHelper, clientNodes);
+ *   Simulator::Run ();
+ *   uint32_t capacity = search->GetCapacity ();
+ * \endcode
+ */
+class HttpCapacitySearch : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return type ID
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Constructor.
+   */
+  HttpCapacitySearch ();
+
+  /**
+   * \brief Destructor.
+   */
+  virtual ~HttpCapacitySearch ();
+
+  /**
+   * \brief Point of the load-versus-latency curve.
+   */
+  struct Point
+  {
+    uint32_t users;         //!< Number of users during the step.
+    uint64_t pages;         //!< Number of pages loaded during the step.
+    uint64_t outstanding;   //!< Number of pages still loading at the end of the step.
+    uint64_t failed;        //!< Number of pages failed during the step, e.g. on a full server queue.
+    double pagesPerSecond;  //!< Page load rate during the step.
+    Time mean;              //!< Mean page load time.
+    Time percentile;        //!< Percentile of the page load time compared with the SLO, pages still loading counted with their age, failed pages ranking last.
+    bool withinSlo;         //!< True if the step did not break the SLO. A step with users and no page loaded breaks it.
+  };
+
+  /**
+   * \brief Start the search now.
+   * \param helper helper that installs the clients, with their attributes set.
+   * \param nodes nodes the clients are installed on.
+   */
+  void Start (const HttpClientHelper &helper, NodeContainer nodes);
+
+  /**
+   * \brief Get the load-versus-latency curve measured so far.
+   * \return one point per completed step.
+   */
+  const std::vector<Point> &GetCurve (void) const;
+
+  /**
+   * \brief Get the highest number of users that kept the page load time
+   * within the SLO.
+   * \return the number of users, 0 if even the first step broke the SLO.
+   */
+  uint32_t GetCapacity (void) const;
+
+  /**
+   * \brief Check if the search has found the load breaking the SLO.
+   * \return true if a step broke the SLO.
+   */
+  bool IsSaturated (void) const;
+
+protected:
+  /**
+   * \brief Dispose this object;
+   */
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief End the current step, if any, and start the next one.
+   */
+  void Step (void);
+
+  /**
+   * \brief Record the point of the current step.
+   * \return true if the step broke the SLO.
+   */
+  bool EndStep (void);
+
+  /**
+   * \brief Add users on the next client nodes.
+   * \param users number of users to add.
+   */
+  void AddUsers (uint32_t users);
+
+  /**
+   * \brief PageLoaded trace sink of the clients.
+   * \param pageId sequence number of the web page.
+   * \param numOfInlineObjects number of inline objects of the page.
+   * \param delay page load time.
+   * \param size page size.
+   */
+  void PageLoaded (uint32_t pageId, uint32_t numOfInlineObjects, Time delay, uint32_t size);
+
+  /**
+   * \brief PageFailed trace sink of the clients.
+   * \param pageId sequence number of the web page.
+   * \param numOfInlineObjects number of inline objects of the page.
+   * \param delay time until the page was abandoned.
+   */
+  void PageFailed (uint32_t pageId, uint32_t numOfInlineObjects, Time delay);
+
+  /**
+   * \brief Write the curve to OutputFile.
+   */
+  void WriteCurve (void) const;
+
+  HttpClientHelper m_helper;             //!< Helper installing the clients.
+  NodeContainer m_nodes;                 //!< Client nodes.
+  ApplicationContainer m_clients;        //!< Clients installed.
+  uint32_t m_nextNode;                   //!< Node the next users are installed on.
+
+  uint32_t m_initialUsers;               //!< Number of users of the first step.
+  uint32_t m_usersPerStep;               //!< Number of users added at each following step.
+  Time m_stepDuration;                   //!< Duration of each step.
+  Time m_settlingTime;                   //!< Start of each step not measured.
+  bool m_ramp;                           //!< True to spread the new users over the step.
+  uint32_t m_maxSteps;                   //!< Maximum number of steps.
+  Time m_slo;                            //!< Page load time SLO.
+  double m_percentile;                   //!< Percentile compared with the SLO.
+  std::string m_outputFile;              //!< Name of the output file.
+
+  uint32_t m_users;                      //!< Number of users installed.
+  Time m_stepStart;                      //!< Start of the current step.
+  HttpLatencyHistogram m_stepHistogram;  //!< Page load times of the current step.
+  uint64_t m_stepFailures;               //!< Pages failed during the current step.
+  std::vector<Point> m_curve;            //!< Load-versus-latency curve.
+  bool m_saturated;                      //!< True once a step broke the SLO.
+};
+
+}
+
+#endif /* HTTP_CAPACITY_SEARCH_H_ */
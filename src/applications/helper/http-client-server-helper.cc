@@ -60,6 +60,25 @@ HttpServerHelper::Install (NodeContainer c)
   return apps;
 }
 
+int64_t
+HttpServerHelper::AssignStreams (NodeContainer c, int64_t stream)
+{
+  int64_t currentStream = stream;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNApplications (); j++)
+        {
+          Ptr<HttpServer> server = DynamicCast<HttpServer> (node->GetApplication (j));
+          if (server)
+            {
+              currentStream += server->AssignStreams (currentStream);
+            }
+        }
+    }
+  return (currentStream - stream);
+}
+
 
 
 HttpClientHelper::HttpClientHelper (Address address, uint16_t port)
@@ -115,6 +134,70 @@ HttpClientHelper::Install (NodeContainer c)
   return apps;
 }
 
+ApplicationContainer
+HttpClientHelper::Install (NodeContainer c, uint32_t usersPerNode)
+{
+  ObjectFactory factory = m_factory;
+  m_factory.Set ("NumOfUsers", UintegerValue (usersPerNode));
+  ApplicationContainer apps = Install (c);
+  m_factory = factory;
+  return apps;
+}
+
+int64_t
+HttpClientHelper::AssignStreams (NodeContainer c, int64_t stream)
+{
+  int64_t currentStream = stream;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNApplications (); j++)
+        {
+          Ptr<HttpClient> client = DynamicCast<HttpClient> (node->GetApplication (j));
+          if (client)
+            {
+              currentStream += client->AssignStreams (currentStream);
+            }
+        }
+    }
+  return (currentStream - stream);
+}
+
+HttpProxyHelper::HttpProxyHelper (Address upstream, uint16_t upstreamPort, uint16_t port)
+{
+  m_factory.SetTypeId (HttpProxy::GetTypeId ());
+  SetAttribute ("UpstreamAddress", AddressValue (upstream));
+  SetAttribute ("UpstreamPort", UintegerValue (upstreamPort));
+  SetAttribute ("Port", UintegerValue (port));
+}
+
+void
+HttpProxyHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+ApplicationContainer
+HttpProxyHelper::Install (Ptr<Node> node)
+{
+  ApplicationContainer apps;
+  Ptr<HttpProxy> proxy = m_factory.Create<HttpProxy> ();
+  node->AddApplication (proxy);
+  apps.Add (proxy);
+  return apps;
+}
+
+ApplicationContainer
+HttpProxyHelper::Install (NodeContainer c)
+{
+  ApplicationContainer apps;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      apps.Add (Install (*i));
+    }
+  return apps;
+}
+
 } // namespace ns3
 
 
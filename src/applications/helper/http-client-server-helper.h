@@ -27,6 +27,7 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/http-client.h"
 #include "ns3/http-server.h"
+#include "ns3/http-proxy.h"
 
 namespace ns3 {
 
@@ -61,6 +62,17 @@ public:
    */
   ApplicationContainer Install (Ptr<Node> node);
 
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by the HttpServerApplications installed on the given nodes.
+   *
+   * \param c NodeContainer of the set of nodes for which the HttpServerApplications
+   * should be modified to use a fixed stream.
+   * \param stream first stream index to use.
+   * \return the number of stream indices assigned by this helper.
+   */
+  int64_t AssignStreams (NodeContainer c, int64_t stream);
+
 private:
   ObjectFactory m_factory;
 
@@ -101,12 +113,74 @@ public:
    */
   ApplicationContainer Install (Ptr<Node> node);
 
+  /**
+   * Install an ns3::HttpClientApplication that runs several user sessions
+   * on each node of the input container, configured with all the attributes
+   * set with SetAttribute.
+   *
+   * \param c NodeContainer of the set of nodes on which a HttpClientApplication
+   * will be installed.
+   * \param usersPerNode number of user sessions run on each node.
+   */
+  ApplicationContainer Install (NodeContainer c, uint32_t usersPerNode);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by the HttpClientApplications installed on the given nodes.
+   *
+   * \param c NodeContainer of the set of nodes for which the HttpClientApplications
+   * should be modified to use a fixed stream.
+   * \param stream first stream index to use.
+   * \return the number of stream indices assigned by this helper.
+   */
+  int64_t AssignStreams (NodeContainer c, int64_t stream);
+
 //  Ptr<http::HttpClient> GetClient (void);
 //
 private:
   ObjectFactory m_factory;
 };
 
+
+class HttpProxyHelper
+{
+public:
+  /**
+   * \param upstream address of the server the misses are forwarded to.
+   * \param upstreamPort port of the server.
+   * \param port port on which the proxy listens for clients.
+   */
+  HttpProxyHelper (Address upstream, uint16_t upstreamPort, uint16_t port);
+
+  /**
+   * Record an attribute to be set in each Application after it is is created.
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Install an ns3::HttpProxy on each node of the input container
+   * configured with all the attributes set with SetAttribute.
+   *
+   * \param c NodeContainer of the set of nodes on which a HttpProxy
+   * will be installed.
+   */
+  ApplicationContainer Install (NodeContainer c);
+
+  /**
+   * Install an ns3::HttpProxy on a node configured with all the
+   * attributes set with SetAttribute.
+   *
+   * \param node The node on which a HttpProxy will be installed.
+   */
+  ApplicationContainer Install (Ptr<Node> node);
+
+private:
+  ObjectFactory m_factory;
+};
+
 } // namespace ns3
 
 
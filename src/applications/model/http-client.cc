@@ -21,10 +21,18 @@
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 #include "ns3/uinteger.h"
+#include "ns3/pointer.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
+#include "ns3/abort.h"
+#include "ns3/trace-source-accessor.h"
+#include <algorithm>
+#include <cmath>
 
 #include "http-client.h"
 
@@ -46,6 +54,136 @@ HttpClient::GetTypeId (void)
                    UintegerValue (80),
                    MakeUintegerAccessor (&HttpClient::m_peerPort),
                    MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("PipelineDepth",
+                   "Maximum number of inline object requests outstanding on each connection. "
+                   "A value of 1 disables pipelining.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&HttpClient::m_pipelineDepth),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxConnectionsPerServer",
+                   "Maximum number of parallel connections opened to the server. "
+                   "Inline objects are fetched over all of them.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&HttpClient::m_maxConnections),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Multiplexing",
+                   "Use the multiplexed, HTTP/2-style framed transport instead of HTTP/1.1: "
+                   "every session fetches all objects over one connection, each on its own "
+                   "stream. PipelineDepth and MaxConnectionsPerServer are then ignored. The "
+                   "server must use it too.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&HttpClient::m_multiplexing),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxConcurrentStreams",
+                   "Maximum number of streams open at once on a multiplexed connection, like "
+                   "the HTTP/2 SETTINGS_MAX_CONCURRENT_STREAMS setting.",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&HttpClient::m_maxConcurrentStreams),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("NumOfUsers",
+                   "Number of independent user sessions (browsing users) run by the application.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&HttpClient::m_numOfUsers),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("UserStartWindow",
+                   "The user sessions start evenly spread over this interval after the "
+                   "application starts.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&HttpClient::m_userStartWindow),
+                   MakeTimeChecker ())
+    .AddAttribute ("WarmStart",
+                   "Start every closed-loop user session as if it had been browsing for a long "
+                   "time: in the reading time after a page, with the residual reading time drawn "
+                   "from its stationary distribution, so the sessions are not synchronized at the "
+                   "start. Replaces UserStartWindow.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&HttpClient::m_warmStart),
+                   MakeBooleanChecker ())
+    .AddAttribute ("WarmStartSamples",
+                   "Number of reading times sampled to draw the residual reading times of the "
+                   "warm start.",
+                   UintegerValue (10000),
+                   MakeUintegerAccessor (&HttpClient::m_warmStartSamples),
+                   MakeUintegerChecker<uint32_t> (1))
+    //Mu and Sigma data was taken from paper "An HTTP Web Traffic Model Based on the
+    //Top One Million Visited Web Pages" by Rastin Pries et. al (Table II).
+    .AddAttribute ("ReadingTime",
+                   "A RandomVariableStream used to pick the reading time (in seconds) between web pages.",
+                   StringValue ("ns3::LogNormalRandomVariable[Mu=-0.495204|Sigma=2.7731]"),
+                   MakePointerAccessor (&HttpClient::m_readingTimeStream),
+                   MakePointerChecker <RandomVariableStream>())
+    .AddAttribute ("WorkloadTrace",
+                   "Workload trace whose pages and reading times are replayed. If not set, "
+                   "the reading time is taken from ReadingTime and the server samples the objects.",
+                   PointerValue (),
+                   MakePointerAccessor (&HttpClient::m_workloadTrace),
+                   MakePointerChecker<HttpWorkloadTrace> ())
+    .AddAttribute ("FirstTracePage",
+                   "Index of the first trace page replayed. Each user session then replays the "
+                   "following pages, wrapping around at the end of the trace. The sessions "
+                   "start evenly spread over the trace.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&HttpClient::m_firstTracePage),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("CatalogSize",
+                   "Number of pages of the server site catalog (see the HttpServer CatalogSize "
+                   "attribute). If not 0, each page is picked by Zipf popularity. Ignored when "
+                   "a WorkloadTrace is set.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&HttpClient::m_catalogSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ZipfExponent",
+                   "Exponent of the Zipf popularity of the catalog pages.",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&HttpClient::m_zipfExponent),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("PageInterArrivalTime",
+                   "A RandomVariableStream used to pick the time (in seconds) between page "
+                   "arrivals of the open-loop mode, e.g. ns3::ExponentialRandomVariable for "
+                   "Poisson arrivals or ns3::ConstantRandomVariable for a fixed rate. If not "
+                   "set, the NumOfUsers sessions are closed loop.",
+                   PointerValue (),
+                   MakePointerAccessor (&HttpClient::m_pageInterArrivalTime),
+                   MakePointerChecker<RandomVariableStream> ())
+    .AddAttribute ("MaxOutstandingPages",
+                   "Maximum number of open-loop pages loading at once, each on its own "
+                   "connections. Arrivals beyond it are rejected.",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&HttpClient::m_maxOutstandingPages),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("EventLog",
+                   "An HttpEventLog recording the requests, responses and pages of the sessions "
+                   "in binary form, a cheaper alternative to the log output for many clients.",
+                   PointerValue (),
+                   MakePointerAccessor (&HttpClient::m_eventLog),
+                   MakePointerChecker<HttpEventLog> ())
+    .AddTraceSource ("OutstandingPages",
+                     "Number of open-loop pages loading.",
+                     MakeTraceSourceAccessor (&HttpClient::m_outstandingPages),
+                     "ns3::TracedValueCallback::Uint32")
+    .AddTraceSource ("ConnectionEstablished",
+                     "Time from the connection request until the server accepted it.",
+                     MakeTraceSourceAccessor (&HttpClient::m_connectionEstablishedTrace),
+                     "ns3::HttpClient::TimeTracedCallback")
+    .AddTraceSource ("TimeToFirstByte",
+                     "Time from the main object request until the first byte of the response.",
+                     MakeTraceSourceAccessor (&HttpClient::m_timeToFirstByteTrace),
+                     "ns3::HttpClient::TimeTracedCallback")
+    .AddTraceSource ("ObjectDownloaded",
+                     "Time from the request of an object until it was completely received, and its size.",
+                     MakeTraceSourceAccessor (&HttpClient::m_objectDownloadedTrace),
+                     "ns3::HttpClient::TimeSizeTracedCallback")
+    .AddTraceSource ("PageLoaded",
+                     "Time from the main object request until the last object of the web page "
+                     "was received, and the total size of the page.",
+                     MakeTraceSourceAccessor (&HttpClient::m_pageLoadedTrace),
+                     "ns3::HttpClient::TimeSizeTracedCallback")
+    .AddTraceSource ("PageFailed",
+                     "Time from the main object request until a web page was abandoned, "
+                     "after a response with a status other than 200 (e.g. 503 from a full "
+                     "server queue).",
+                     MakeTraceSourceAccessor (&HttpClient::m_pageFailedTrace),
+                     "ns3::HttpClient::TimeTracedCallback")
   ;
   return tid;
 }
@@ -53,17 +191,14 @@ HttpClient::GetTypeId (void)
 HttpClient::HttpClient ()
 {
   NS_LOG_FUNCTION (this);
-  m_socket = 0;
-  m_contentLength = 0;
-  m_bytesReceived = 0;
-  m_numOfInlineObjects = 0;
-  m_inlineObjLoaded = 0;
-
-  //Mu and Sigma data was taken from paper "An HTTP Web Traffic Model Based on the
-  //Top One Million Visited Web Pages" by Rastin Pries et. al (Table II).
-  m_readingTimeStream = CreateObject<LogNormalRandomVariable> ();
-  m_readingTimeStream->SetAttribute("Mu", DoubleValue (-0.495204));
-  m_readingTimeStream->SetAttribute("Sigma", DoubleValue (2.7731));
+  m_catalogPageStream = CreateObject<UniformRandomVariable> ();
+  m_warmStartStream = CreateObject<UniformRandomVariable> ();
+  m_pagesStarted = 0;
+  m_nextTracePage = 0;
+  m_rejectedPages = 0;
+  m_failedPages = 0;
+  m_outstandingPages = 0;
+  m_nodeId = 0;
 }
 
 HttpClient::~HttpClient ()
@@ -75,44 +210,174 @@ void
 HttpClient::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_connections.clear ();
+  m_socketIndex.clear ();
+  m_sessions.clear ();
+  m_readingTimeStream = 0;
+  m_workloadTrace = 0;
+  m_catalogPageStream = 0;
+  m_warmStartStream = 0;
+  m_pageInterArrivalTime = 0;
+  m_eventLog = 0;
+  m_idleSessions.clear ();
   Application::DoDispose ();
 }
 
+int64_t
+HttpClient::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_readingTimeStream->SetStream (stream);
+  m_catalogPageStream->SetStream (stream + 1);
+  if (m_pageInterArrivalTime != 0)
+    {
+      m_pageInterArrivalTime->SetStream (stream + 2);
+    }
+  m_warmStartStream->SetStream (stream + 3);
+  return 4;
+}
+
+uint64_t
+HttpClient::GetRejectedPages (void) const
+{
+  return m_rejectedPages;
+}
+
+uint64_t
+HttpClient::GetFailedPages (void) const
+{
+  return m_failedPages;
+}
+
+std::vector<Time>
+HttpClient::GetLoadingPageAges (void) const
+{
+  std::vector<Time> ages;
+  for (std::vector<Session>::const_iterator it = m_sessions.begin (); it != m_sessions.end (); ++it)
+    {
+      if (it->loading)
+        {
+          ages.push_back (Simulator::Now () - it->pageStart);
+        }
+    }
+  return ages;
+}
+
 void
 HttpClient::StartApplication ()
 {
   NS_LOG_FUNCTION (this);
-  // Create the socket if not already
-  if (!m_socket)
+  // Start the user sessions if not already
+  if (m_sessions.empty ())
     {
-      TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
+      m_nodeId = GetNode ()->GetId ();
+
+      // Every session owns MaxConnectionsPerServer slots, so the vector never grows
+      // and references to its connections stay valid.
+      m_connectionsPerSession = m_multiplexing ? 1 : m_maxConnections;
+      uint32_t numSessions = m_pageInterArrivalTime != 0 ? m_maxOutstandingPages : m_numOfUsers;
+      m_sessions.resize (numSessions);
+      m_connections.resize (numSessions * m_connectionsPerSession);
 
-      m_socket = Socket::CreateSocket (GetNode (), tid);
+      if (m_catalogSize > 0)
+        {
+          InitializeZipf ();
+        }
 
-      // Fatal error if socket type is not NS3_SOCK_STREAM or NS3_SOCK_SEQPACKET
-      if (m_socket->GetSocketType () != Socket::NS3_SOCK_STREAM &&
-          m_socket->GetSocketType () != Socket::NS3_SOCK_SEQPACKET)
+      uint64_t traceStride = 0;
+      if (m_workloadTrace != 0)
         {
-          NS_FATAL_ERROR ("Using HttpClient with an incompatible socket type. "
-                          "HttpClient requires SOCK_STREAM or SOCK_SEQPACKET. "
-                          "In other words, use TCP instead of UDP.");
+          NS_ABORT_MSG_IF (m_workloadTrace->GetNumPages () == 0, "HttpClient >> The WorkloadTrace has no pages.");
+          traceStride = std::max (m_workloadTrace->GetNumPages () / m_numOfUsers, static_cast<uint64_t> (1));
         }
 
-      if (Ipv4Address::IsMatchingType(m_peerAddress) == true)
+      if (m_pageInterArrivalTime != 0)
         {
-          m_socket->Bind ();
-          m_socket->Connect (InetSocketAddress (Ipv4Address::ConvertFrom(m_peerAddress), m_peerPort));
+          // Open loop: the sessions are slots taken by the pages as they arrive.
+          for (uint32_t i = 0; i < numSessions; i++)
+            {
+              m_sessions[i].firstConnection = i * m_connectionsPerSession;
+              m_idleSessions.push_back (numSessions - 1 - i);
+            }
+          m_nextTracePage = m_firstTracePage;
+          m_nextArrival = Simulator::Schedule (Seconds (m_pageInterArrivalTime->GetValue ()),
+                                               &HttpClient::StartPage, this);
+          return;
         }
-      else if (Ipv6Address::IsMatchingType(m_peerAddress) == true)
+
+      std::vector<double> warmStartDelays;
+      if (m_warmStart)
         {
-          m_socket->Bind6 ();
-          m_socket->Connect (Inet6SocketAddress (Ipv6Address::ConvertFrom(m_peerAddress), m_peerPort));
+          DrawResidualReadingTimes (warmStartDelays);
         }
 
+      for (uint32_t i = 0; i < m_numOfUsers; i++)
+        {
+          Session &session = m_sessions[i];
+          session.firstConnection = i * m_connectionsPerSession;
+          if (m_workloadTrace != 0)
+            {
+              session.page = (m_firstTracePage + i * traceStride) % m_workloadTrace->GetNumPages ();
+            }
+
+          if (m_warmStart)
+            {
+              session.startEvent = Simulator::Schedule (Seconds (warmStartDelays[i]),
+                                                        &HttpClient::OpenConnection, this, i);
+            }
+          else if (m_userStartWindow.IsZero ())
+            {
+              OpenConnection (i);
+            }
+          else
+            {
+              session.startEvent = Simulator::Schedule (Seconds (m_userStartWindow.GetSeconds () * i / m_numOfUsers),
+                                                        &HttpClient::OpenConnection, this, i);
+            }
+        }
+    }
+}
+
+void
+HttpClient::DrawResidualReadingTimes (std::vector<double> &delays)
+{
+  NS_LOG_FUNCTION (this);
+
+  // A user browsing for a long time is far more likely to be in a long
+  // reading time than in a short one: the reading time it is in follows the
+  // length-biased distribution, and the time left is a uniform part of it.
+  // The length-biased draw picks one of WarmStartSamples reading times with
+  // a probability proportional to its length. Page loads are short next to
+  // the reading times, so every session starts reading.
+  std::vector<double> cumulative (m_warmStartSamples);
+  double total = 0;
+  for (uint32_t i = 0; i < m_warmStartSamples; i++)
+    {
+      double readingTime;
+      if (m_workloadTrace != 0)
+        {
+          readingTime = m_workloadTrace->GetReadingTime ((m_firstTracePage + i) % m_workloadTrace->GetNumPages ()).GetSeconds ();
+        }
+      else
+        {
+          readingTime = std::min (m_readingTimeStream->GetValue (), 10000.0);
+        }
+      total += readingTime;
+      cumulative[i] = total;
     }
 
-  m_socket->SetConnectCallback (MakeCallback (&HttpClient::ConnectionSucceeded, this),
-                                MakeCallback (&HttpClient::ConnectionFailed, this));
+  delays.resize (m_numOfUsers);
+  for (uint32_t i = 0; i < m_numOfUsers; i++)
+    {
+      std::vector<double>::const_iterator it =
+        std::upper_bound (cumulative.begin (), cumulative.end (), m_warmStartStream->GetValue (0, total));
+      if (it == cumulative.end ())
+        {
+          --it;
+        }
+      double readingTime = *it - (it == cumulative.begin () ? 0 : *(it - 1));
+      delays[i] = m_warmStartStream->GetValue () * readingTime;
+    }
 }
 
 void
@@ -120,14 +385,86 @@ HttpClient::StopApplication ()
 {
   NS_LOG_FUNCTION (this);
 
-  if (m_socket != 0)
+  Simulator::Cancel (m_nextArrival);
+  // Sessions not started yet must not open connections after the stop.
+  for (std::vector<Session>::iterator it = m_sessions.begin (); it != m_sessions.end (); ++it)
     {
-      m_socket->Close ();
+      Simulator::Cancel (it->startEvent);
     }
-  else
+  if (m_rejectedPages > 0)
+    {
+      NS_LOG_WARN ("HttpClient >> " << m_rejectedPages << " open-loop page arrivals rejected.");
+    }
+  if (m_failedPages > 0)
+    {
+      NS_LOG_WARN ("HttpClient >> " << m_failedPages << " pages failed.");
+    }
+
+  if (m_socketIndex.empty ())
     {
       NS_LOG_WARN ("HttpClientApplication found null socket to close in StopApplication");
     }
+
+  for (std::vector<Connection>::iterator it = m_connections.begin (); it != m_connections.end (); ++it)
+    {
+      if (it->socket != 0)
+        {
+          it->socket->Close ();
+        }
+    }
+}
+
+void
+HttpClient::OpenConnection (uint32_t sessionIndex)
+{
+  NS_LOG_FUNCTION (this << sessionIndex);
+
+  Session &session = m_sessions[sessionIndex];
+  NS_ASSERT (session.numConnections < m_connectionsPerSession);
+  uint32_t index = session.firstConnection + session.numConnections;
+  session.numConnections++;
+
+  TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
+
+  Connection &conn = m_connections[index];
+  conn.socket = Socket::CreateSocket (GetNode (), tid);
+  conn.session = sessionIndex;
+
+  // Fatal error if socket type is not NS3_SOCK_STREAM or NS3_SOCK_SEQPACKET
+  if (conn.socket->GetSocketType () != Socket::NS3_SOCK_STREAM &&
+      conn.socket->GetSocketType () != Socket::NS3_SOCK_SEQPACKET)
+    {
+      NS_FATAL_ERROR ("Using HttpClient with an incompatible socket type. "
+                      "HttpClient requires SOCK_STREAM or SOCK_SEQPACKET. "
+                      "In other words, use TCP instead of UDP.");
+    }
+
+  if (Ipv4Address::IsMatchingType(m_peerAddress) == true)
+    {
+      conn.socket->Bind ();
+      conn.socket->Connect (InetSocketAddress (Ipv4Address::ConvertFrom(m_peerAddress), m_peerPort));
+    }
+  else if (Ipv6Address::IsMatchingType(m_peerAddress) == true)
+    {
+      conn.socket->Bind6 ();
+      conn.socket->Connect (Inet6SocketAddress (Ipv6Address::ConvertFrom(m_peerAddress), m_peerPort));
+    }
+
+  conn.socket->SetConnectCallback (MakeCallback (&HttpClient::ConnectionSucceeded, this),
+                                   MakeCallback (&HttpClient::ConnectionFailed, this));
+  conn.connectStart = Simulator::Now ();
+  m_socketIndex[conn.socket] = index;
+}
+
+HttpClient::Connection *
+HttpClient::FindConnection (Ptr<Socket> socket)
+{
+  std::map<Ptr<Socket>, uint32_t>::const_iterator it = m_socketIndex.find (socket);
+  if (it == m_socketIndex.end ())
+    {
+      return 0;
+    }
+  return &m_connections[it->second];
 }
 
 
@@ -139,7 +476,22 @@ HttpClient::ConnectionSucceeded (Ptr<Socket> socket)
   m_clientAddress = temp;
   NS_LOG_DEBUG ("HttpClient (" << m_clientAddress << ") >> Server accepted connection request!");
   socket->SetRecvCallback (MakeCallback (&HttpClient::HandleReceive, this));
-  SendRequest(socket, "main/object");
+
+  Connection *conn = FindConnection (socket);
+  NS_ASSERT (conn != 0);
+  conn->connected = true;
+  Session &session = m_sessions[conn->session];
+  m_connectionEstablishedTrace (session.pageId, session.numOfInlineObjects, Simulator::Now () - conn->connectStart);
+
+  if (conn == &m_connections[session.firstConnection])
+    {
+      RequestMainObject (conn->session);
+    }
+  else
+    {
+      // A new connection of the pool is ready to take inline object requests.
+      RequestInlineObjects (session);
+    }
 }
 
 void
@@ -150,7 +502,7 @@ HttpClient::ConnectionFailed (Ptr<Socket> socket)
 }
 
 void
-HttpClient::SendRequest(Ptr<Socket> socket, string url)
+HttpClient::SendRequest(Connection &conn, string url)
 {
   NS_LOG_FUNCTION (this);
 
@@ -165,135 +517,459 @@ HttpClient::SendRequest(Ptr<Socket> socket, string url)
   packet->AddHeader (m_httpHeader);
   NS_LOG_INFO("HttpClient (" << m_clientAddress << ") >> Sending request for "
               << url << " to server (" << Ipv4Address::ConvertFrom (m_peerAddress) << ").");
-  socket->Send(packet);
+  conn.outstanding++;
+  if (m_multiplexing)
+    {
+      // Each request opens a new client stream, with an odd identifier.
+      HttpFrameHeader frame;
+      frame.SetType (HttpFrameHeader::HEADERS);
+      frame.SetFlags (HttpFrameHeader::END_HEADERS | HttpFrameHeader::END_STREAM);
+      frame.SetLength (packet->GetSize ());
+      frame.SetStreamId (conn.nextStreamId);
+      packet->AddHeader (frame);
+      conn.streams[conn.nextStreamId].requestTime = Simulator::Now ();
+      conn.nextStreamId += 2;
+    }
+  else
+    {
+      conn.requestTimes.push_back (Simulator::Now ());
+    }
+  conn.socket->Send(packet);
+
+  if (m_eventLog != 0)
+    {
+      RecordEvent (HttpEventLog::REQUEST_SENT, conn, m_sessions[conn.session].inlineObjRequested);
+    }
+}
+
+void
+HttpClient::RecordEvent (HttpEventLog::EventType type, const Connection &conn, uint32_t value)
+{
+  const Session &session = m_sessions[conn.session];
+  m_eventLog->Record (type, m_nodeId, conn.session, session.pageId,
+                      &conn - &m_connections[session.firstConnection], value);
+}
+
+void
+HttpClient::RequestMainObject (uint32_t sessionIndex)
+{
+  NS_LOG_FUNCTION (this << sessionIndex);
+
+  Session &session = m_sessions[sessionIndex];
+  session.numOfInlineObjects = 0;
+  session.inlineObjLoaded = 0;
+  session.inlineObjRequested = 0;
+  session.pageStart = Simulator::Now ();
+  session.pageBytes = 0;
+  session.waitingFirstByte = true;
+  session.firstBytePending = false;
+  session.pageFailed = false;
+  session.loading = true;
+
+  if (m_workloadTrace == 0 && m_catalogSize > 0)
+    {
+      session.page = PickCatalogPage ();
+    }
+
+  // The main object of every web page is requested on the first connection of the session.
+  Connection &conn = m_connections[session.firstConnection];
+  if (UsesPageUrls ())
+    {
+      SendRequest (conn, HttpWorkloadTrace::GetMainObjectUrl (session.page));
+    }
+  else
+    {
+      SendRequest (conn, "main/object");
+    }
 }
 
+void
+HttpClient::StartPage (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Arrivals do not wait for the pages already loading.
+  m_nextArrival = Simulator::Schedule (Seconds (m_pageInterArrivalTime->GetValue ()),
+                                       &HttpClient::StartPage, this);
+
+  if (m_idleSessions.empty ())
+    {
+      m_rejectedPages++;
+      NS_LOG_DEBUG ("HttpClient >> " << m_maxOutstandingPages << " pages loading, page arrival rejected.");
+      return;
+    }
+
+  uint32_t sessionIndex = m_idleSessions.back ();
+  m_idleSessions.pop_back ();
+  m_outstandingPages = m_outstandingPages + 1;
+
+  Session &session = m_sessions[sessionIndex];
+  session.pageId = m_pagesStarted++;
+  if (m_workloadTrace != 0)
+    {
+      session.page = m_nextTracePage;
+      m_nextTracePage = (m_nextTracePage + 1) % m_workloadTrace->GetNumPages ();
+    }
+
+  // The connections of the slot stay open between its pages.
+  if (session.numConnections == 0)
+    {
+      OpenConnection (sessionIndex);
+    }
+  else
+    {
+      RequestMainObject (sessionIndex);
+    }
+}
 
 void
 HttpClient::HandleReceive (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
 
-  double readingTime;
-  HttpHeader httpHeaderIn;
-  Ptr<Packet> packet = socket->Recv();
+  Connection *conn = FindConnection (socket);
+  NS_ASSERT (conn != 0);
+  Session &session = m_sessions[conn->session];
 
-  packet->PeekHeader(httpHeaderIn);
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      if (packet->GetSize () == 0)
+        { //EOF
+          break;
+        }
 
-  string statusCode = httpHeaderIn.GetStatusCode();
+      if (session.waitingFirstByte && conn == &m_connections[session.firstConnection])
+        {
+          session.waitingFirstByte = false;
+          session.firstBytePending = true;
+          session.firstByteTime = Simulator::Now ();
+        }
 
-  uint32_t bytesReceived = packet->GetSize ();
+      if (m_eventLog != 0)
+        {
+          RecordEvent (HttpEventLog::BODY_PROGRESS, *conn, packet->GetSize ());
+        }
+
+      if (m_multiplexing)
+        {
+          while (conn->frameParser.Parse (packet))
+            {
+              FrameReceived (*conn);
+            }
+          continue;
+        }
 
-  if (statusCode == "200")
+      // A single read may hold the end of one response and the start of the next.
+      while (conn->parser.Parse (packet))
+        {
+          // Responses arrive in request order, so the oldest send time is this object's.
+          NS_ASSERT (!conn->requestTimes.empty ());
+          Time requestTime = conn->requestTimes.front ();
+          conn->requestTimes.pop_front ();
+          conn->outstanding--;
+          if (m_eventLog != 0 && !conn->headerLogged)
+            {
+              RecordEvent (HttpEventLog::HEADER_RECEIVED, *conn, conn->parser.GetContentLength ());
+            }
+          conn->headerLogged = false;
+          ObjectReceived (*conn, conn->parser.GetHeader (), conn->parser.GetContentLength (), requestTime);
+        }
+
+      if (m_eventLog != 0 && !conn->headerLogged && conn->parser.IsHeaderComplete ())
+        {
+          RecordEvent (HttpEventLog::HEADER_RECEIVED, *conn, conn->parser.GetContentLength ());
+          conn->headerLogged = true;
+        }
+
+      // The time to first byte is reported once the main object header tells
+      // how many inline objects the page has.
+      if (session.firstBytePending && conn->parser.IsHeaderComplete ()
+          && conn->parser.GetHeader ().GetStatusCode () == "200")
+        {
+          NotifyFirstByte (session, conn->parser.GetHeader ().GetNumOfInlineObjects ());
+        }
+
+      if (conn->parser.IsHeaderComplete ())
+        {
+          NS_LOG_DEBUG ("HttpClient (" << m_clientAddress << ") >> "
+                        << HttpHeader::ContentTypeToString (conn->parser.GetHeader ().GetContentType ()) << ": "
+                        << conn->parser.GetBodyReceived () << " bytes of "
+                        << conn->parser.GetContentLength () << " received.");
+        }
+    }
+}
+
+void
+HttpClient::FrameReceived (Connection &conn)
+{
+  NS_LOG_FUNCTION (this << conn.socket);
+
+  const HttpFrameHeader &frame = conn.frameParser.GetFrameHeader ();
+  std::map<uint32_t, Stream>::iterator it = conn.streams.find (frame.GetStreamId ());
+  if (it == conn.streams.end ())
+    {
+      NS_LOG_WARN ("HttpClient (" << m_clientAddress << ") >> Frame received on unknown stream "
+                   << frame.GetStreamId () << ".");
+      return;
+    }
+
+  Stream &stream = it->second;
+  Session &session = m_sessions[conn.session];
+  if (frame.GetType () == HttpFrameHeader::HEADERS)
+    {
+      stream.header = conn.frameParser.GetHeader ();
+      if (m_eventLog != 0)
+        {
+          RecordEvent (HttpEventLog::HEADER_RECEIVED, conn, stream.header.GetContentLength ());
+        }
+      if (session.firstBytePending && stream.header.GetContentType () == HttpHeader::MAIN_OBJECT
+          && stream.header.GetStatusCode () == "200")
+        {
+          NotifyFirstByte (session, stream.header.GetNumOfInlineObjects ());
+        }
+    }
+  else
+    {
+      stream.bodyReceived += frame.GetLength ();
+    }
+
+  if (frame.IsEndStream ())
+    {
+      // Closing the stream first, as the next requests may open new ones.
+      HttpHeader header = stream.header;
+      uint32_t size = stream.bodyReceived;
+      Time requestTime = stream.requestTime;
+      conn.streams.erase (it);
+      conn.outstanding--;
+      ObjectReceived (conn, header, size, requestTime);
+    }
+}
+
+void
+HttpClient::ObjectReceived (Connection &conn, const HttpHeader &httpHeaderIn, uint32_t size, Time requestTime)
+{
+  NS_LOG_FUNCTION (this << conn.socket << size);
+
+  Session &session = m_sessions[conn.session];
+  const char *contentType = HttpHeader::ContentTypeToString (httpHeaderIn.GetContentType ());
+
+  NS_LOG_DEBUG ("HttpClient (" << m_clientAddress << ") >> " << contentType << ": "
+                << size << " bytes received.");
+
+  // An error response, such as the 503 of a full server queue, ends the
+  // page as failed: it must not count as a fast download.
+  bool ok = httpHeaderIn.GetStatusCode () == "200";
+  if (!ok)
     {
-      m_contentType = httpHeaderIn.GetHeaderField("ContentType");
-      m_contentLength = atoi(httpHeaderIn.GetHeaderField("ContentLength").c_str());
+      NS_LOG_INFO ("HttpClient (" << m_clientAddress << ") >> " << contentType << ": "
+                   << httpHeaderIn.GetStatusCode () << " " << httpHeaderIn.GetPhrase ()
+                   << " received, the page failed.");
+      session.pageFailed = true;
+      session.firstBytePending = false;
+    }
 
-      m_bytesReceived = bytesReceived - httpHeaderIn.GetSerializedSize();
+  if(httpHeaderIn.GetContentType () == HttpHeader::MAIN_OBJECT)
+    {
+      session.numOfInlineObjects = ok ? httpHeaderIn.GetNumOfInlineObjects () : 0;
+      if (ok)
+        {
+          NotifyFirstByte (session, session.numOfInlineObjects);
+          NS_LOG_INFO ("HttpClient (" << m_clientAddress << ") >> " << contentType <<
+                       " successfully received. There are " << session.numOfInlineObjects << " inline objects to request.");
+        }
+      session.inlineObjLoaded = 0;
+      session.inlineObjRequested = 0;
 
-      if(m_contentType == "main/object")
+      // Opening the rest of the connection pool, no more connections than objects to fetch.
+      uint32_t poolSize = std::min (m_connectionsPerSession, std::max (session.numOfInlineObjects, 1u));
+      while (session.numConnections < poolSize)
         {
-          m_numOfInlineObjects = atoi(httpHeaderIn.GetHeaderField("NumOfInlineObjects").c_str());
+          OpenConnection (conn.session);
         }
+    }
+  else
+    {
+      session.inlineObjLoaded++;
+      NS_LOG_DEBUG ("HttpClient (" << m_clientAddress << ") >> " << contentType <<
+                    " " << session.inlineObjLoaded << " of " << session.numOfInlineObjects << " received.");
+    }
 
-      if(m_bytesReceived == m_contentLength)
+  if (ok)
+    {
+      session.pageBytes += size;
+      if (m_eventLog != 0)
         {
-    	  NS_LOG_DEBUG ("HttpClient (" << m_clientAddress << ") >> " << m_contentType << ": "
-    	                << m_bytesReceived << " bytes of " << m_contentLength << " received.");
-          m_contentLength = 0;
+          RecordEvent (HttpEventLog::OBJECT_COMPLETE, conn, size);
+        }
+      m_objectDownloadedTrace (session.pageId, session.numOfInlineObjects,
+                               Simulator::Now () - requestTime, size);
+    }
 
-          if(m_contentType == "main/object")
+  // A failed page requests no more objects, it only waits for those on the way.
+  uint32_t expected = session.pageFailed ? session.inlineObjRequested : session.numOfInlineObjects;
+  if(session.inlineObjLoaded < expected)
+    {
+      if (!session.pageFailed)
+        {
+          RequestInlineObjects (session);
+        }
+    }
+  else
+    {
+      if (session.pageFailed)
+        {
+          m_failedPages++;
+          m_pageFailedTrace (session.pageId, session.numOfInlineObjects, Simulator::Now () - session.pageStart);
+          if (m_eventLog != 0)
             {
-              NS_LOG_INFO ("HttpClient (" << m_clientAddress << ") >> " << m_contentType <<
-                           " successfully received. There are " << m_numOfInlineObjects << " inline objects to request.");
-              NS_LOG_DEBUG ("HttpClient (" << m_clientAddress << ") >> Requesting inline/object 1...");
-              m_inlineObjLoaded = 0;
-              SendRequest(socket, "inline/object");
+              RecordEvent (HttpEventLog::PAGE_FAILED, conn, session.pageBytes);
             }
-          else
+        }
+      else
+        {
+          m_pageLoadedTrace (session.pageId, session.numOfInlineObjects, Simulator::Now () - session.pageStart, session.pageBytes);
+          if (m_eventLog != 0)
             {
-              m_inlineObjLoaded++;
-              if(m_inlineObjLoaded < m_numOfInlineObjects)
-                {
-                  NS_LOG_DEBUG ("HttpClient (" << m_clientAddress << ") >> Requesting inline/object "
-                                << m_inlineObjLoaded + 1 << "...");
-                  SendRequest(socket, "inline/object");
-                }
-              else
-                {
-                  readingTime = m_readingTimeStream->GetValue();
-                  //Limiting reading time to 10000 seconds according to paper "An HTTP Web Traffic
-                  //Model Based on the Top One Million Visited Web Pages" by Rastin Pries et. al (Table II).
-                  if(readingTime > 10000)
-                    {
-                      readingTime = 10000;
-                    }
-
-                  NS_LOG_DEBUG ("HttpClient (" << m_clientAddress << ") >> Reading time: " << readingTime << " seconds.");
-                  Simulator::Schedule (Seconds(readingTime), &HttpClient::SendRequest, this, socket, "main/object");
-                }
+              RecordEvent (HttpEventLog::PAGE_COMPLETE, conn, session.pageBytes);
             }
         }
+      session.loading = false;
+      session.pageId++;
+
+      if (m_pageInterArrivalTime != 0)
+        {
+          // Open loop: the slot waits for the next page arrival, not for a reading time.
+          m_idleSessions.push_back (conn.session);
+          m_outstandingPages = m_outstandingPages - 1;
+          return;
+        }
+
+      double readingTime;
+      if (m_workloadTrace != 0)
+        {
+          readingTime = m_workloadTrace->GetReadingTime (session.page).GetSeconds ();
+          session.page = (session.page + 1) % m_workloadTrace->GetNumPages ();
+        }
       else
         {
-          NS_LOG_DEBUG ("HttpClient (" << m_clientAddress << ") >> " << m_contentType << ": "
-                        << m_bytesReceived << " bytes of " << m_contentLength << " received.");
+          readingTime = m_readingTimeStream->GetValue();
+          //Limiting reading time to 10000 seconds according to paper "An HTTP Web Traffic
+          //Model Based on the Top One Million Visited Web Pages" by Rastin Pries et. al (Table II).
+          if(readingTime > 10000)
+            {
+              readingTime = 10000;
+            }
         }
+
+      NS_LOG_DEBUG ("HttpClient (" << m_clientAddress << ") >> Reading time: " << readingTime << " seconds.");
+      Simulator::Schedule (Seconds(readingTime), &HttpClient::RequestMainObject, this, conn.session);
     }
-  else
+}
+
+void
+HttpClient::NotifyFirstByte (Session &session, uint32_t numOfInlineObjects)
+{
+  NS_LOG_FUNCTION (this << numOfInlineObjects);
+
+  if (session.firstBytePending)
     {
-      m_bytesReceived += bytesReceived;
+      session.firstBytePending = false;
+      m_timeToFirstByteTrace (session.pageId, numOfInlineObjects, session.firstByteTime - session.pageStart);
+    }
+}
 
-      if(m_bytesReceived == m_contentLength)
-        {
-    	  NS_LOG_DEBUG ("HttpClient (" << m_clientAddress << ") >> " << m_contentType << ": "
-    	                << m_bytesReceived << " bytes of " << m_contentLength << " received.");
-          m_contentLength = 0;
+void
+HttpClient::RequestInlineObjects (Session &session)
+{
+  NS_LOG_FUNCTION (this);
 
-          if(m_contentType == "main/object")
+  // Spreading the requests over the connections of the session, one level of
+  // the pipeline at a time, so idle connections are used first. A multiplexed
+  // connection takes as many requests as it may have open streams.
+  uint32_t end = session.firstConnection + session.numConnections;
+  uint32_t maxOutstanding = m_multiplexing ? m_maxConcurrentStreams : m_pipelineDepth;
+  for (uint32_t depth = 1; depth <= maxOutstanding; depth++)
+    {
+      for (uint32_t i = session.firstConnection; i < end; i++)
+        {
+          if (session.inlineObjRequested == session.numOfInlineObjects)
             {
-              NS_LOG_INFO ("HttpClient (" << m_clientAddress << ") >> " << m_contentType <<
-                           " successfully received. There are " << m_numOfInlineObjects << " inline objects to request.");
-              NS_LOG_DEBUG ("HttpClient (" << m_clientAddress << ") >> Requesting inline/object 1...");
-              m_inlineObjLoaded = 0;
-              SendRequest(socket, "inline/object");
+              return;
             }
-          else
+
+          Connection &conn = m_connections[i];
+          if (conn.connected && conn.outstanding < depth)
             {
-              m_inlineObjLoaded++;
-              if(m_inlineObjLoaded < m_numOfInlineObjects)
+              session.inlineObjRequested++;
+              NS_LOG_DEBUG ("HttpClient (" << m_clientAddress << ") >> Requesting inline/object "
+                            << session.inlineObjRequested << "...");
+              if (UsesPageUrls ())
                 {
-                  NS_LOG_DEBUG ("HttpClient (" << m_clientAddress << ") >> " << m_contentType << " " << m_inlineObjLoaded <<
-                                " of " << m_numOfInlineObjects << " successfully received."
-                                "\nHttpClient >> Requesting inline/object " << m_inlineObjLoaded + 1);
-                  SendRequest(socket, "inline/object");
+                  SendRequest (conn, HttpWorkloadTrace::GetInlineObjectUrl (session.page, session.inlineObjRequested - 1));
                 }
               else
                 {
-                  NS_LOG_DEBUG ("HttpClient (" << m_clientAddress << ") >> " << m_contentType <<
-                                " " << m_inlineObjLoaded << " of " << m_numOfInlineObjects << " successfully received.");
-                  readingTime = m_readingTimeStream->GetValue();
-                  //Limiting reading time to 10000 seconds according to paper "An HTTP Web Traffic
-                  //Model Based on the Top One Million Visited Web Pages" by Rastin Pries et. al (Table II).
-                  if(readingTime > 10000)
-                    {
-                      readingTime = 10000;
-                    }
-
-                  NS_LOG_DEBUG ("HttpClient (" << m_clientAddress << ") >> Reading time: " << readingTime << " seconds.");
-                  Simulator::Schedule (Seconds(readingTime), &HttpClient::SendRequest, this, socket, "main/object");
+                  SendRequest(conn, "inline/object");
                 }
             }
         }
-      else
+    }
+}
+
+bool
+HttpClient::UsesPageUrls (void) const
+{
+  return m_workloadTrace != 0 || m_catalogSize > 0;
+}
+
+void
+HttpClient::InitializeZipf (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_zipfHIntegralX1 = ZipfHIntegral (1.5) - 1.0;
+  m_zipfHIntegralN = ZipfHIntegral (m_catalogSize + 0.5);
+  m_zipfS = 2.0 - ZipfHIntegralInverse (ZipfHIntegral (2.5) - std::exp (-m_zipfExponent * std::log (2.0)));
+}
+
+uint32_t
+HttpClient::PickCatalogPage (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Drawing from the continuous hat function, and accepting the rank if it is
+  // under the Zipf distribution. Less than 2 draws are needed on average.
+  while (true)
+    {
+      double u = m_zipfHIntegralN + m_catalogPageStream->GetValue () * (m_zipfHIntegralX1 - m_zipfHIntegralN);
+      double x = ZipfHIntegralInverse (u);
+      double k = std::floor (x + 0.5);
+      k = std::min (std::max (k, 1.0), static_cast<double> (m_catalogSize));
+      if (k - x <= m_zipfS || u >= ZipfHIntegral (k + 0.5) - std::exp (-m_zipfExponent * std::log (k)))
         {
-          NS_LOG_DEBUG ("HttpClient (" << m_clientAddress << ") >> " << m_contentType << ": " <<
-                        m_bytesReceived << " bytes of " << m_contentLength << " received.");
+          return static_cast<uint32_t> (k) - 1;
         }
     }
 }
 
+double
+HttpClient::ZipfHIntegral (double x) const
+{
+  double logX = std::log (x);
+  double t = (1.0 - m_zipfExponent) * logX;
+  // (exp (t) - 1) / t, also accurate for t close to 0.
+  double helper = std::fabs (t) > 1e-8 ? expm1 (t) / t : 1.0 + t / 2.0 * (1.0 + t / 3.0 * (1.0 + t / 4.0));
+  return helper * logX;
 }
 
+double
+HttpClient::ZipfHIntegralInverse (double x) const
+{
+  double t = std::max (x * (1.0 - m_zipfExponent), -1.0);
+  // log (1 + t) / t, also accurate for t close to 0.
+  double helper = std::fabs (t) > 1e-8 ? log1p (t) / t : 1.0 - t * (0.5 - t * (1.0 / 3.0 - t / 4.0));
+  return std::exp (helper * x);
+}
 
-
+}
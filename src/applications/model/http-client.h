@@ -24,7 +24,18 @@
 #include "ns3/socket.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
+#include "ns3/event-id.h"
 #include "ns3/http-header.h"
+#include "ns3/http-stream-parser.h"
+#include "ns3/http-frame-parser.h"
+#include "ns3/http-workload-trace.h"
+#include "ns3/http-event-log.h"
+#include <vector>
+#include <deque>
+#include <map>
 
 using namespace std;
 namespace ns3 {
@@ -39,14 +50,35 @@ namespace ns3 {
  * object, it process the message and start to request the inline objects
  * of the given web page. After receiving all inline objects, the client
  * waits an interval (reading time) before it requests a new main object
- * of a new web page. The implementation of this application is simplistic
- * and it does not support pipelining in this current version. The
- * model used is based on the distributions indicated in the paper
- * "An HTTP Web Traffic Model Based on the Top One Million Visited
- * Web Pages" by Rastin Pries et. al. This simplistic approach was
- * taken since this traffic generator was developed primarily to help
- * users evaluate their proposed algorithm in other modules of NS-3.
- * To allow deeper studies about the HTTP Protocol it needs some improvements.
+ * of a new web page. Like a browser, the client may open up to
+ * MaxConnectionsPerServer connections and fetch the inline objects over
+ * all of them in parallel. With the PipelineDepth attribute the client
+ * keeps several inline object requests outstanding on each connection
+ * (HTTP/1.1 pipelining). With the WorkloadTrace attribute the client
+ * replays the pages and reading times of a trace (see HttpWorkloadTrace)
+ * instead of sampling them. With the CatalogSize attribute the client
+ * picks the pages of the server site catalog by Zipf popularity. With the
+ * Multiplexing attribute each session fetches all objects over a single
+ * connection of a framed, HTTP/2-style transport (see HttpFrameHeader),
+ * with up to MaxConcurrentStreams requests in flight, each on its own
+ * stream.
+ *
+ * A single application may run NumOfUsers independent browsing sessions,
+ * each with its own connections and pages, which costs much less memory
+ * than one application per user. These users are closed loop: the offered
+ * load backs off when pages load slowly. With the PageInterArrivalTime
+ * attribute the client is open loop instead: pages start on that arrival
+ * process whether or not the previous ones have loaded. Each page then
+ * runs in one of MaxOutstandingPages session slots, on the connections of
+ * that slot.
+ *
+ * The implementation of this application is simplistic. The model used
+ * is based on the distributions indicated in the paper "An HTTP Web
+ * Traffic Model Based on the Top One Million Visited Web Pages" by Rastin
+ * Pries et. al. This simplistic approach was taken since this traffic
+ * generator was developed primarily to help users evaluate their proposed
+ * algorithm in other modules of NS-3. To allow deeper studies about the
+ * HTTP Protocol it needs some improvements.
  */
 class HttpClient : public Application
 {
@@ -67,6 +99,57 @@ public:
    */
   virtual ~HttpClient ();
 
+  /**
+   * \brief Assign a fixed random variable stream number to the random variables
+   * used by this model.
+   * \param stream first stream index to use.
+   * \return the number of stream indices assigned by this model.
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * \brief Get the number of open-loop page arrivals rejected because
+   * MaxOutstandingPages pages were loading.
+   * \return the number of rejected pages.
+   */
+  uint64_t GetRejectedPages (void) const;
+
+  /**
+   * \brief Get the number of pages abandoned after an error response.
+   * \return the number of failed pages.
+   */
+  uint64_t GetFailedPages (void) const;
+
+  /**
+   * \brief Get for how long each page still loading has been loading, a
+   * lower bound of its load time.
+   * \return one age per page loading.
+   */
+  std::vector<Time> GetLoadingPageAges (void) const;
+
+  /**
+   * TracedCallback signature for page-level delays.
+   *
+   * \param [in] pageId sequence number of the web page in its user session,
+   *              starting at 0.
+   * \param [in] numOfInlineObjects number of inline objects of the page
+   *              (0 while the main object header is not known yet).
+   * \param [in] delay the measured delay.
+   */
+  typedef void (* TimeTracedCallback)(uint32_t pageId, uint32_t numOfInlineObjects, Time delay);
+
+  /**
+   * TracedCallback signature for page-level delays of a download.
+   *
+   * \param [in] pageId sequence number of the web page in its user session,
+   *              starting at 0.
+   * \param [in] numOfInlineObjects number of inline objects of the page.
+   * \param [in] delay the measured delay.
+   * \param [in] size number of body bytes downloaded.
+   */
+  typedef void (* TimeSizeTracedCallback)(uint32_t pageId, uint32_t numOfInlineObjects,
+                                          Time delay, uint32_t size);
+
 protected:
   /**
    * \brief Dispose this object;
@@ -85,15 +168,118 @@ private:
   virtual void StopApplication (void);
 
 
+  /**
+   * \brief State kept for each open stream of a multiplexed connection.
+   */
+  struct Stream
+  {
+    Stream () : bodyReceived (0) {}
+
+    Time requestTime;       //!< Send time of the request.
+    HttpHeader header;      //!< Response header, once its HEADERS frame arrived.
+    uint32_t bodyReceived;  //!< Body bytes received so far.
+  };
+
+  /**
+   * \brief State kept for each connection to the server.
+   */
+  struct Connection
+  {
+    Connection () : session (0), connected (false), outstanding (0), nextStreamId (1), headerLogged (false) {}
+
+    Ptr<Socket> socket;             //!< Local socket, 0 while the slot is unused.
+    uint32_t session;               //!< Index of the user session owning the connection.
+    bool connected;                 //!< True once the server accepted the connection.
+    HttpStreamParser parser;        //!< Parser of the received responses.
+    uint32_t outstanding;           //!< Requests sent and not answered yet.
+    Time connectStart;              //!< Time the connection request was sent.
+    std::deque<Time> requestTimes;  //!< Send time of the outstanding requests, in order.
+    HttpFrameParser frameParser;    //!< Parser of the received frames, when multiplexed.
+    uint32_t nextStreamId;          //!< Identifier of the next stream opened, when multiplexed.
+    std::map<uint32_t, Stream> streams;  //!< Open streams, when multiplexed.
+    bool headerLogged;              //!< True once the header of the current response was logged.
+  };
+
+  /**
+   * \brief State kept for each user session (browsing user) of the application.
+   *
+   * The connections of a session are the MaxConnectionsPerServer slots of
+   * m_connections starting at firstConnection. The first one carries the
+   * main objects.
+   */
+  struct Session
+  {
+    Session ()
+      : firstConnection (0), numConnections (0), numOfInlineObjects (0),
+        inlineObjLoaded (0), inlineObjRequested (0), pageId (0), pageBytes (0),
+        waitingFirstByte (false), firstBytePending (false), pageFailed (false), loading (false), page (0) {}
+
+    uint32_t firstConnection;     //!< Index of the first connection slot of the session.
+    uint32_t numConnections;      //!< Number of connections opened.
+    uint32_t numOfInlineObjects;  //!< Number-of-Inline-Objects header line of the current page.
+    uint32_t inlineObjLoaded;     //!< Number of inline objects already loaded.
+    uint32_t inlineObjRequested;  //!< Number of inline objects already requested.
+    uint32_t pageId;              //!< Sequence number of the current web page.
+    uint32_t pageBytes;           //!< Body bytes received for the current web page.
+    Time pageStart;               //!< Time the main object of the current page was requested.
+    Time firstByteTime;           //!< Time the first byte of the current main object arrived.
+    bool waitingFirstByte;        //!< True from the main object request until its first byte.
+    bool firstBytePending;        //!< True from the first byte until its trace is fired.
+    bool pageFailed;              //!< True once a response of the current page was an error.
+    bool loading;                 //!< True from the main object request until the page ends.
+    uint64_t page;                //!< Trace or catalog page of the current web page.
+    EventId startEvent;           //!< Delayed start of the session.
+  };
+
+  /**
+   * \brief Open a new connection of a session to the server.
+   * \param session index of the session.
+   */
+  void OpenConnection (uint32_t session);
+
+  /**
+   * \brief Find the connection that owns a socket.
+   * \param socket the socket.
+   * \return the connection, or 0 if the socket is not in the pool.
+   */
+  Connection *FindConnection (Ptr<Socket> socket);
+
   void ConnectionSucceeded (Ptr<Socket> socket);
   void ConnectionFailed (Ptr<Socket> socket);
 
   /**
    * \brief Send the request to server side.
-   * \param socket socket that sends requests.
+   * \param conn connection that sends the request.
    * \param url URL of the object requested.
    */
-  void SendRequest (Ptr<Socket> socket, string url);
+  void SendRequest (Connection &conn, string url);
+
+  /**
+   * \brief Record an event of a connection in the event log.
+   * \param type the event type.
+   * \param conn the connection.
+   * \param value value of the event.
+   */
+  void RecordEvent (HttpEventLog::EventType type, const Connection &conn, uint32_t value);
+
+  /**
+   * \brief Request the main object of a new web page.
+   * \param session index of the session.
+   */
+  void RequestMainObject (uint32_t session);
+
+  /**
+   * \brief Draw the residual reading time each session starts in, for the
+   * warm start.
+   * \param delays set to the start delay (in seconds) of each session.
+   */
+  void DrawResidualReadingTimes (std::vector<double> &delays);
+
+  /**
+   * \brief Start an open-loop page arrival on an idle session slot, and
+   * schedule the next arrival.
+   */
+  void StartPage (void);
 
   /**
    * \brief Receive method.
@@ -102,9 +288,125 @@ private:
   void HandleReceive (Ptr<Socket> socket);
 
   /**
-   * \brief Local socket.
+   * \brief Handle a frame received on a multiplexed connection.
+   * \param conn connection the frame was received on.
+   */
+  void FrameReceived (Connection &conn);
+
+  /**
+   * \brief Handle a completely received object and request the next ones.
+   * \param conn connection the object was received on.
+   * \param header response header of the object.
+   * \param size body size of the object.
+   * \param requestTime send time of the request.
+   */
+  void ObjectReceived (Connection &conn, const HttpHeader &header, uint32_t size, Time requestTime);
+
+  /**
+   * \brief Spread inline object requests over the connected connections
+   * of a session until every pipeline is full or all of them have been requested.
+   * \param session the session.
+   */
+  void RequestInlineObjects (Session &session);
+
+  /**
+   * \brief Fire the time to first byte trace of the current page once.
+   * \param session the session.
+   * \param numOfInlineObjects number of inline objects of the page.
+   */
+  void NotifyFirstByte (Session &session, uint32_t numOfInlineObjects);
+
+  /**
+   * \brief Check if the pages are taken from a workload trace or a catalog.
+   * \return true if the requests carry page URLs.
+   */
+  bool UsesPageUrls (void) const;
+
+  /**
+   * \brief Prepare the Zipf sampler of catalog pages.
+   */
+  void InitializeZipf (void);
+
+  /**
+   * \brief Pick a catalog page by Zipf popularity, with the rejection-inversion
+   * method of Hormann and Derflinger, in constant time and memory.
+   * \return the page index, page 0 being the most popular.
+   */
+  uint32_t PickCatalogPage (void);
+
+  /**
+   * \brief Integral of the Zipf hat function.
+   * \param x the point.
+   * \return the integral.
+   */
+  double ZipfHIntegral (double x) const;
+
+  /**
+   * \brief Inverse of ZipfHIntegral.
+   * \param x the integral.
+   * \return the point.
+   */
+  double ZipfHIntegralInverse (double x) const;
+
+  /**
+   * \brief Connection slots of all sessions, MaxConnectionsPerServer per session.
+   */
+  std::vector<Connection> m_connections;
+
+  /**
+   * \brief Index in m_connections of each open socket.
+   */
+  std::map<Ptr<Socket>, uint32_t> m_socketIndex;
+
+  /**
+   * \brief User sessions.
    */
-  Ptr<Socket> m_socket;
+  std::vector<Session> m_sessions;
+
+  /**
+   * \brief Number of user sessions.
+   */
+  uint32_t m_numOfUsers;
+
+  /**
+   * \brief Interval over which the sessions are started.
+   */
+  Time m_userStartWindow;
+
+  /**
+   * \brief True to start the sessions in a residual reading time.
+   */
+  bool m_warmStart;
+
+  /**
+   * \brief Number of reading times sampled for the warm start.
+   */
+  uint32_t m_warmStartSamples;
+
+  /**
+   * \brief Random Variable Stream for the warm start.
+   */
+  Ptr<UniformRandomVariable> m_warmStartStream;
+
+  /**
+   * \brief Maximum number of connections in the pool of each session.
+   */
+  uint32_t m_maxConnections;
+
+  /**
+   * \brief Connection slots of each session: MaxConnectionsPerServer, or 1 when multiplexed.
+   */
+  uint32_t m_connectionsPerSession;
+
+  /**
+   * \brief True to use the multiplexed, framed transport.
+   */
+  bool m_multiplexing;
+
+  /**
+   * \brief Maximum number of open streams per connection, when multiplexed.
+   */
+  uint32_t m_maxConcurrentStreams;
 
   /**
    * \brief Address of the server.
@@ -122,39 +424,129 @@ private:
   HttpHeader m_httpHeader;
 
   /**
-   * \brief Content-Length header line.
+   * \brief Maximum number of outstanding inline object requests per connection.
    */
-  uint32_t m_contentLength;
+  uint32_t m_pipelineDepth;
 
   /**
-   * \brief Content-Type header line.
+   * \brief Random Variable Stream for reading time, shared by all sessions.
    */
-  string m_contentType;
+  Ptr<RandomVariableStream> m_readingTimeStream;
 
   /**
-   * \brief Number-of-Inline-Objects header line.
+   * \brief client Address.
    */
-  uint32_t m_numOfInlineObjects;
+  Ipv4Address m_clientAddress;
 
   /**
-   * \brief Number of bytes received from server.
+   * \brief Workload trace replayed, if any.
    */
-  uint32_t m_bytesReceived;
+  Ptr<HttpWorkloadTrace> m_workloadTrace;
 
   /**
-   * \brief Number of inline objects already loaded.
+   * \brief Trace page the first session starts with.
    */
-  uint32_t m_inlineObjLoaded;
+  uint64_t m_firstTracePage;
 
   /**
-   * \brief Random Variable Stream for reading time.
+   * \brief Number of pages of the server site catalog, 0 if not used.
    */
-  Ptr<LogNormalRandomVariable> m_readingTimeStream;
+  uint32_t m_catalogSize;
 
   /**
-   * \brief client Address.
+   * \brief Exponent of the Zipf popularity of the catalog pages.
    */
-  Ipv4Address m_clientAddress;
+  double m_zipfExponent;
+
+  /**
+   * \brief Random Variable Stream for the catalog page choice.
+   */
+  Ptr<UniformRandomVariable> m_catalogPageStream;
+
+  double m_zipfHIntegralX1;  //!< ZipfHIntegral (1.5) - 1.
+  double m_zipfHIntegralN;   //!< ZipfHIntegral (CatalogSize + 0.5).
+  double m_zipfS;            //!< Acceptance constant of the rejection-inversion method.
+
+  /**
+   * \brief Random Variable Stream for the time (in seconds) between open-loop
+   * page arrivals, 0 for closed-loop users.
+   */
+  Ptr<RandomVariableStream> m_pageInterArrivalTime;
+
+  /**
+   * \brief Maximum number of open-loop pages loading at once.
+   */
+  uint32_t m_maxOutstandingPages;
+
+  /**
+   * \brief Session slots without a loading page, in open-loop mode.
+   */
+  std::vector<uint32_t> m_idleSessions;
+
+  /**
+   * \brief Next open-loop page arrival.
+   */
+  EventId m_nextArrival;
+
+  /**
+   * \brief Number of open-loop pages started.
+   */
+  uint32_t m_pagesStarted;
+
+  /**
+   * \brief Trace page of the next open-loop page.
+   */
+  uint64_t m_nextTracePage;
+
+  /**
+   * \brief Number of open-loop page arrivals rejected.
+   */
+  uint64_t m_rejectedPages;
+
+  /**
+   * \brief Number of pages abandoned after an error response.
+   */
+  uint64_t m_failedPages;
+
+  /**
+   * \brief Number of open-loop pages loading.
+   */
+  TracedValue<uint32_t> m_outstandingPages;
+
+  /**
+   * \brief Binary event log, if any.
+   */
+  Ptr<HttpEventLog> m_eventLog;
+
+  /**
+   * \brief Id of the node, as recorded in the event log.
+   */
+  uint32_t m_nodeId;
+
+  /**
+   * \brief Trace of the connection setup time.
+   */
+  TracedCallback<uint32_t, uint32_t, Time> m_connectionEstablishedTrace;
+
+  /**
+   * \brief Trace of the time to first byte of the main objects.
+   */
+  TracedCallback<uint32_t, uint32_t, Time> m_timeToFirstByteTrace;
+
+  /**
+   * \brief Trace of the download time and size of each object.
+   */
+  TracedCallback<uint32_t, uint32_t, Time, uint32_t> m_objectDownloadedTrace;
+
+  /**
+   * \brief Trace of the load time and size of each web page.
+   */
+  TracedCallback<uint32_t, uint32_t, Time, uint32_t> m_pageLoadedTrace;
+
+  /**
+   * \brief Trace of the time until each failed web page was abandoned.
+   */
+  TracedCallback<uint32_t, uint32_t, Time> m_pageFailedTrace;
 };
 
 }
@@ -0,0 +1,350 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/http-client.h"
+#include "http-early-stop-controller.h"
+#include <cmath>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HttpEarlyStopController");
+
+NS_OBJECT_ENSURE_REGISTERED (HttpEarlyStopController);
+
+namespace {
+
+/**
+ * \brief Quantile of the standard normal distribution, by the rational
+ * approximation of P. J. Acklam (relative error below 1.15e-9).
+ * \param p probability, in (0, 1).
+ * \return the quantile.
+ */
+double
+NormalQuantile (double p)
+{
+  static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                              1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+  static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                              6.680131188771972e+01, -1.328068155288572e+01 };
+  static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                              -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+  static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                              3.754408661907416e+00 };
+  const double pLow = 0.02425;
+
+  if (p < pLow)
+    {
+      double q = std::sqrt (-2 * std::log (p));
+      return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5])
+             / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    }
+  if (p > 1 - pLow)
+    {
+      return -NormalQuantile (1 - p);
+    }
+  double q = p - 0.5;
+  double r = q * q;
+  return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q
+         / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+}
+
+TypeId
+HttpEarlyStopController::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HttpEarlyStopController")
+    .SetParent<Object> ()
+    .AddConstructor<HttpEarlyStopController> ()
+    .AddAttribute ("Metric",
+                   "The metric whose mean must reach the precision.",
+                   EnumValue (HttpStatsCollector::PAGE_LOAD_TIME),
+                   MakeEnumAccessor (&HttpEarlyStopController::m_metric),
+                   MakeEnumChecker (HttpStatsCollector::PAGE_LOAD_TIME, "PageLoadTime",
+                                    HttpStatsCollector::TIME_TO_FIRST_BYTE, "TimeToFirstByte",
+                                    HttpStatsCollector::OBJECT_DOWNLOAD_TIME, "ObjectDownloadTime"))
+    .AddAttribute ("WarmupTime",
+                   "Samples before this simulation time are ignored.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&HttpEarlyStopController::m_warmupTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("RelativePrecision",
+                   "The simulation stops once the half-width of the confidence interval of the "
+                   "mean, relative to the mean, is below this value.",
+                   DoubleValue (0.05),
+                   MakeDoubleAccessor (&HttpEarlyStopController::m_relativePrecision),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("ConfidenceLevel",
+                   "Confidence level of the interval, at most 0.99, where the t quantile "
+                   "of the interval is still accurate.",
+                   DoubleValue (0.95),
+                   MakeDoubleAccessor (&HttpEarlyStopController::m_confidenceLevel),
+                   MakeDoubleChecker<double> (0.5, 0.99))
+    .AddAttribute ("BatchSize",
+                   "Number of samples of the first batches.",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&HttpEarlyStopController::m_initialBatchSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MinBatches",
+                   "Number of complete batches needed before the simulation can stop. "
+                   "At least 5, so the t quantile of the interval is accurate.",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&HttpEarlyStopController::m_minBatches),
+                   MakeUintegerChecker<uint32_t> (5))
+    .AddAttribute ("MaxBatches",
+                   "Number of complete batches at which neighbour batches are merged, doubling "
+                   "the batch size. Must be even and at least 2 MinBatches.",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&HttpEarlyStopController::m_maxBatches),
+                   MakeUintegerChecker<uint32_t> (10))
+  ;
+  return tid;
+}
+
+HttpEarlyStopController::HttpEarlyStopController ()
+  : m_batchSize (0),
+    m_batchSum (0),
+    m_batchCount (0),
+    m_relativeHalfWidth (std::numeric_limits<double>::infinity ()),
+    m_converged (false),
+    m_reportScheduled (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HttpEarlyStopController::~HttpEarlyStopController ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HttpEarlyStopController::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_batchMeans.clear ();
+  Object::DoDispose ();
+}
+
+void
+HttpEarlyStopController::Install (ApplicationContainer apps)
+{
+  NS_LOG_FUNCTION (this);
+
+  NS_ABORT_MSG_IF (m_maxBatches % 2 != 0 || m_maxBatches < 2 * m_minBatches,
+                   "HttpEarlyStopController >> MaxBatches must be even and at least 2 MinBatches.");
+  if (m_batchSize == 0)
+    {
+      m_batchSize = m_initialBatchSize;
+      m_batchMeans.reserve (m_maxBatches);
+    }
+
+  for (ApplicationContainer::Iterator it = apps.Begin (); it != apps.End (); ++it)
+    {
+      Ptr<HttpClient> client = DynamicCast<HttpClient> (*it);
+      if (client == 0)
+        {
+          continue;
+        }
+
+      switch (m_metric)
+        {
+        case HttpStatsCollector::PAGE_LOAD_TIME:
+          client->TraceConnectWithoutContext ("PageLoaded",
+                                              MakeBoundCallback (&HttpEarlyStopController::SizedDelayReceived, this));
+          break;
+        case HttpStatsCollector::TIME_TO_FIRST_BYTE:
+          client->TraceConnectWithoutContext ("TimeToFirstByte",
+                                              MakeBoundCallback (&HttpEarlyStopController::DelayReceived, this));
+          break;
+        default:
+          client->TraceConnectWithoutContext ("ObjectDownloaded",
+                                              MakeBoundCallback (&HttpEarlyStopController::SizedDelayReceived, this));
+          break;
+        }
+    }
+
+  if (!m_reportScheduled)
+    {
+      m_reportScheduled = true;
+      Simulator::ScheduleDestroy (&HttpEarlyStopController::Report, Ptr<HttpEarlyStopController> (this));
+    }
+}
+
+void
+HttpEarlyStopController::SizedDelayReceived (HttpEarlyStopController *controller, uint32_t pageId,
+                                             uint32_t numOfInlineObjects, Time delay, uint32_t size)
+{
+  controller->AddSample (delay);
+}
+
+void
+HttpEarlyStopController::DelayReceived (HttpEarlyStopController *controller, uint32_t pageId,
+                                        uint32_t numOfInlineObjects, Time delay)
+{
+  controller->AddSample (delay);
+}
+
+void
+HttpEarlyStopController::AddSample (Time delay)
+{
+  if (m_converged || Simulator::Now () < m_warmupTime)
+    {
+      return;
+    }
+
+  m_batchSum += delay.GetSeconds ();
+  if (++m_batchCount < m_batchSize)
+    {
+      return;
+    }
+
+  m_batchMeans.push_back (m_batchSum / m_batchCount);
+  m_batchSum = 0;
+  m_batchCount = 0;
+
+  if (m_batchMeans.size () == m_maxBatches)
+    {
+      for (uint32_t i = 0; i < m_maxBatches / 2; i++)
+        {
+          m_batchMeans[i] = (m_batchMeans[2 * i] + m_batchMeans[2 * i + 1]) / 2;
+        }
+      m_batchMeans.resize (m_maxBatches / 2);
+      m_batchSize *= 2;
+      NS_LOG_DEBUG ("HttpEarlyStopController >> Batch size doubled to " << m_batchSize << " samples.");
+    }
+
+  uint32_t n = m_batchMeans.size ();
+  if (n < 2)
+    {
+      return;
+    }
+
+  double mean = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      mean += m_batchMeans[i];
+    }
+  mean /= n;
+  double variance = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      variance += (m_batchMeans[i] - mean) * (m_batchMeans[i] - mean);
+    }
+  variance /= n - 1;
+
+  double halfWidth = GetStudentTQuantile ((1 + m_confidenceLevel) / 2, n - 1) * std::sqrt (variance / n);
+  m_relativeHalfWidth = mean > 0 ? halfWidth / mean : std::numeric_limits<double>::infinity ();
+  NS_LOG_DEBUG ("HttpEarlyStopController >> " << n << " batches, mean " << mean
+                << " s, relative half-width " << m_relativeHalfWidth);
+
+  if (n >= m_minBatches && m_relativeHalfWidth < m_relativePrecision)
+    {
+      m_converged = true;
+      m_stopTime = Simulator::Now ();
+      NS_LOG_INFO ("HttpEarlyStopController >> Precision reached at " << m_stopTime.GetSeconds ()
+                   << " s: mean " << mean << " s +- " << m_relativeHalfWidth * 100 << "%.");
+      Simulator::Stop ();
+    }
+}
+
+bool
+HttpEarlyStopController::IsConverged (void) const
+{
+  return m_converged;
+}
+
+Time
+HttpEarlyStopController::GetMean (void) const
+{
+  if (m_batchMeans.empty ())
+    {
+      return Seconds (0);
+    }
+  double mean = 0;
+  for (uint32_t i = 0; i < m_batchMeans.size (); i++)
+    {
+      mean += m_batchMeans[i];
+    }
+  return Seconds (mean / m_batchMeans.size ());
+}
+
+double
+HttpEarlyStopController::GetRelativeHalfWidth (void) const
+{
+  return m_relativeHalfWidth;
+}
+
+uint64_t
+HttpEarlyStopController::GetSampleCount (void) const
+{
+  return m_batchMeans.size () * m_batchSize;
+}
+
+uint32_t
+HttpEarlyStopController::GetNumBatches (void) const
+{
+  return m_batchMeans.size ();
+}
+
+Time
+HttpEarlyStopController::GetStopTime (void) const
+{
+  return m_stopTime;
+}
+
+double
+HttpEarlyStopController::GetStudentTQuantile (double p, uint32_t degreesOfFreedom)
+{
+  // Cornish-Fisher expansion around the normal quantile (Abramowitz and
+  // Stegun 26.7.5). From 4 degrees of freedom and up to 99% confidence it
+  // is at most 0.3% below t (4.594 for 4.604 at 99%). With fewer degrees
+  // of freedom or a higher confidence it underestimates t badly, which is
+  // why MinBatches is at least 5 and ConfidenceLevel at most 0.99.
+  double z = NormalQuantile (p);
+  double n = degreesOfFreedom;
+  double z2 = z * z;
+  double g1 = (z2 + 1) * z / 4;
+  double g2 = ((5 * z2 + 16) * z2 + 3) * z / 96;
+  double g3 = (((3 * z2 + 19) * z2 + 17) * z2 - 15) * z / 384;
+  double g4 = ((((79 * z2 + 776) * z2 + 1482) * z2 - 1920) * z2 - 945) * z / 92160;
+  return z + (g1 + (g2 + (g3 + g4 / n) / n) / n) / n;
+}
+
+void
+HttpEarlyStopController::Report (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_converged)
+    {
+      return;
+    }
+  NS_LOG_WARN ("HttpEarlyStopController >> Precision not reached: " << GetNumBatches ()
+               << " batches, mean " << GetMean ().GetSeconds () << " s +- "
+               << m_relativeHalfWidth * 100 << "% (target " << m_relativePrecision * 100 << "%).");
+}
+
+}
@@ -0,0 +1,189 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#ifndef HTTP_EARLY_STOP_CONTROLLER_H_
+#define HTTP_EARLY_STOP_CONTROLLER_H_
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/application-container.h"
+#include "ns3/http-stats-collector.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup http
+ *
+ * Stops the simulation once a metric of many HttpClient applications is
+ * known precisely enough, instead of at a guessed time. The samples of the
+ * metric from all clients, after WarmupTime, are grouped in batches and the
+ * confidence interval of the mean is computed from the batch means
+ * (method of batch means). When the half-width of the interval, relative
+ * to the mean, drops below RelativePrecision with at least MinBatches
+ * batches, Simulator::Stop is called.
+ *
+ * Batches start with BatchSize samples. When MaxBatches batches are
+ * complete, neighbour batches are merged, so their number stays bounded and
+ * they grow with the run, which keeps the batch means nearly independent
+ * even for correlated samples.
+ *
+ * Typical use, with Simulator::Stop as an upper bound:
+ * \code
+ *   Ptr<HttpEarlyStopController> controller = CreateObject<HttpEarlyStopController> ();
+ *   controller->SetAttribute ("RelativePrecision", DoubleValue (0.05));
+ *   controller->Install (httpClientApps);
+ *   Simulator::Stop (Seconds (3600.0));
+ *   Simulator::Run ();
+ *   std::cout << controller->GetMean ().GetSeconds () << " +- "
+ *             << controller->GetRelativeHalfWidth () * 100 << "%" << std::endl;
+ * \endcode
+ */
+class HttpEarlyStopController : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return type ID
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Constructor.
+   */
+  HttpEarlyStopController ();
+
+  /**
+   * \brief Destructor.
+   */
+  virtual ~HttpEarlyStopController ();
+
+  /**
+   * \brief Connect to the trace source of the metric of every HttpClient in
+   * a container. Other applications are ignored.
+   * \param apps the applications.
+   */
+  void Install (ApplicationContainer apps);
+
+  /**
+   * \brief Check whether the target precision was reached.
+   * \return true if the simulation was stopped by the controller.
+   */
+  bool IsConverged (void) const;
+
+  /**
+   * \brief Get the mean of the metric over the complete batches.
+   * \return the mean.
+   */
+  Time GetMean (void) const;
+
+  /**
+   * \brief Get the half-width of the confidence interval of the mean,
+   * relative to the mean.
+   * \return the relative half-width, infinite with less than two batches.
+   */
+  double GetRelativeHalfWidth (void) const;
+
+  /**
+   * \brief Get the number of samples in the complete batches.
+   * \return the number of samples.
+   */
+  uint64_t GetSampleCount (void) const;
+
+  /**
+   * \brief Get the number of complete batches.
+   * \return the number of batches.
+   */
+  uint32_t GetNumBatches (void) const;
+
+  /**
+   * \brief Get the time the controller stopped the simulation.
+   * \return the stop time, zero if it did not converge.
+   */
+  Time GetStopTime (void) const;
+
+  /**
+   * \brief Quantile of the Student t distribution.
+   * \param p probability, in (0, 0.995].
+   * \param degreesOfFreedom degrees of freedom, at least 4.
+   * \return the quantile.
+   */
+  static double GetStudentTQuantile (double p, uint32_t degreesOfFreedom);
+
+protected:
+  /**
+   * \brief Dispose this object;
+   */
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief PageLoaded and ObjectDownloaded trace sink.
+   * \param controller the controller.
+   * \param pageId sequence number of the web page.
+   * \param numOfInlineObjects number of inline objects of the page.
+   * \param delay the sample.
+   * \param size page or object size.
+   */
+  static void SizedDelayReceived (HttpEarlyStopController *controller, uint32_t pageId,
+                                  uint32_t numOfInlineObjects, Time delay, uint32_t size);
+
+  /**
+   * \brief TimeToFirstByte trace sink.
+   * \param controller the controller.
+   * \param pageId sequence number of the web page.
+   * \param numOfInlineObjects number of inline objects of the page.
+   * \param delay the sample.
+   */
+  static void DelayReceived (HttpEarlyStopController *controller, uint32_t pageId,
+                             uint32_t numOfInlineObjects, Time delay);
+
+  /**
+   * \brief Add a sample to the current batch, and check the precision when
+   * the batch is complete.
+   * \param delay the sample.
+   */
+  void AddSample (Time delay);
+
+  /**
+   * \brief Log the precision reached. Called when the simulation is destroyed.
+   */
+  void Report (void) const;
+
+  HttpStatsCollector::Metric m_metric;  //!< Metric watched.
+  Time m_warmupTime;                    //!< Samples before this time are ignored.
+  double m_relativePrecision;           //!< Target relative half-width.
+  double m_confidenceLevel;             //!< Confidence level of the interval.
+  uint32_t m_initialBatchSize;          //!< Number of samples of the first batches.
+  uint32_t m_minBatches;                //!< Batches needed before stopping.
+  uint32_t m_maxBatches;                //!< Batches kept before merging them.
+
+  uint64_t m_batchSize;                 //!< Number of samples per batch.
+  double m_batchSum;                    //!< Sum (in seconds) of the samples of the current batch.
+  uint64_t m_batchCount;                //!< Number of samples of the current batch.
+  std::vector<double> m_batchMeans;     //!< Means (in seconds) of the complete batches.
+  double m_relativeHalfWidth;           //!< Relative half-width at the last complete batch.
+  bool m_converged;                     //!< True once the precision was reached.
+  Time m_stopTime;                      //!< Time the simulation was stopped.
+  bool m_reportScheduled;               //!< True once Report has been scheduled.
+};
+
+}
+
+#endif /* HTTP_EARLY_STOP_CONTROLLER_H_ */
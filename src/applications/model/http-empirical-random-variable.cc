@@ -0,0 +1,234 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "http-empirical-random-variable.h"
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <algorithm>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HttpEmpiricalRandomVariable");
+
+NS_OBJECT_ENSURE_REGISTERED (HttpEmpiricalRandomVariable);
+
+TypeId
+HttpEmpiricalRandomVariable::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HttpEmpiricalRandomVariable")
+    .SetParent<RandomVariableStream> ()
+    .AddConstructor<HttpEmpiricalRandomVariable> ()
+    .AddAttribute ("FileName",
+                   "Name of the file holding the empirical CDF, one \"value,cumulative "
+                   "probability\" point per line.",
+                   StringValue (""),
+                   MakeStringAccessor (&HttpEmpiricalRandomVariable::Load),
+                   MakeStringChecker ())
+    .AddAttribute ("Interpolate",
+                   "Spread the values uniformly between consecutive CDF points. If false, "
+                   "only the values of the points are drawn.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&HttpEmpiricalRandomVariable::m_interpolate),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+HttpEmpiricalRandomVariable::HttpEmpiricalRandomVariable ()
+  : m_interpolate (true)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HttpEmpiricalRandomVariable::~HttpEmpiricalRandomVariable ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HttpEmpiricalRandomVariable::Load (std::string fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+
+  m_fileName = fileName;
+  m_value.clear ();
+  m_lower.clear ();
+  m_prob.clear ();
+  m_alias.clear ();
+  if (fileName.empty ())
+    {
+      return;
+    }
+
+  std::ifstream file (fileName.c_str ());
+  NS_ABORT_MSG_IF (!file.is_open (), "HttpEmpiricalRandomVariable >> Can't open file " << fileName);
+
+  std::vector<double> probabilities;
+  double lastCdf = 0;
+  std::string line;
+  std::string column;
+  uint64_t lineNumber = 0;
+  while (std::getline (file, line))
+    {
+      lineNumber++;
+      if (!line.empty () && line[line.size () - 1] == '\r')
+        {
+          line.erase (line.size () - 1);
+        }
+      if (line.empty () || line[0] == '#')
+        {
+          continue;
+        }
+
+      std::istringstream columns (line);
+      char *end;
+      std::getline (columns, column, ',');
+      double value = strtod (column.c_str (), &end);
+      NS_ABORT_MSG_IF (*end != '\0' || column.empty ()
+                       || (!m_value.empty () && !(value >= m_value.back ())),
+                       "HttpEmpiricalRandomVariable >> " << fileName << ":" << lineNumber << ": bad value.");
+      std::getline (columns, column, ',');
+      double cdf = strtod (column.c_str (), &end);
+      NS_ABORT_MSG_IF (*end != '\0' || column.empty () || !(cdf >= lastCdf) || cdf > 1,
+                       "HttpEmpiricalRandomVariable >> " << fileName << ":" << lineNumber << ": bad cumulative probability.");
+
+      m_lower.push_back (m_value.empty () ? value : m_value.back ());
+      m_value.push_back (value);
+      probabilities.push_back (cdf - lastCdf);
+      lastCdf = cdf;
+    }
+  NS_ABORT_MSG_IF (!(lastCdf > 0), "HttpEmpiricalRandomVariable >> " << fileName << ": empty CDF.");
+
+  for (uint32_t i = 0; i < probabilities.size (); i++)
+    {
+      probabilities[i] /= lastCdf;
+    }
+  BuildAliasTable (probabilities);
+  NS_LOG_INFO ("HttpEmpiricalRandomVariable >> " << m_value.size () << " bins loaded from " << fileName);
+}
+
+void
+HttpEmpiricalRandomVariable::BuildAliasTable (const std::vector<double> &probabilities)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Vose's method: columns holding less than the average mass are topped
+  // up by a column holding more, until every column holds exactly 1/n.
+  uint32_t n = probabilities.size ();
+  m_prob.resize (n);
+  m_alias.resize (n);
+  std::vector<uint32_t> small;
+  std::vector<uint32_t> large;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      m_prob[i] = probabilities[i] * n;
+      m_alias[i] = i;
+      if (m_prob[i] < 1)
+        {
+          small.push_back (i);
+        }
+      else
+        {
+          large.push_back (i);
+        }
+    }
+
+  while (!small.empty () && !large.empty ())
+    {
+      uint32_t less = small.back ();
+      small.pop_back ();
+      uint32_t more = large.back ();
+      m_alias[less] = more;
+      m_prob[more] -= 1 - m_prob[less];
+      if (m_prob[more] < 1)
+        {
+          large.pop_back ();
+          small.push_back (more);
+        }
+    }
+
+  // What is left is only off by rounding errors.
+  for (uint32_t i = 0; i < small.size (); i++)
+    {
+      m_prob[small[i]] = 1;
+    }
+  for (uint32_t i = 0; i < large.size (); i++)
+    {
+      m_prob[large[i]] = 1;
+    }
+}
+
+uint32_t
+HttpEmpiricalRandomVariable::GetNumBins (void) const
+{
+  return m_value.size ();
+}
+
+double
+HttpEmpiricalRandomVariable::GetValue (void)
+{
+  NS_ABORT_MSG_IF (m_prob.empty (), "HttpEmpiricalRandomVariable >> No CDF loaded, set the FileName attribute.");
+
+  double u = Peek ()->RandU01 ();
+  if (IsAntithetic ())
+    {
+      u = 1 - u;
+    }
+
+  // The integer part picks the column, the fraction picks between the bin
+  // of the column and its alias, and what is left of it is still uniform,
+  // so one draw is enough to interpolate too. x is kept below n, so the
+  // fraction is below 1 and a column holding 1 never picks its alias.
+  double n = m_prob.size ();
+  double x = std::min (u * n, n * (1 - std::numeric_limits<double>::epsilon ()));
+  uint32_t column = static_cast<uint32_t> (x);
+  double fraction = x - column;
+  uint32_t bin;
+  double position;
+  if (fraction < m_prob[column])
+    {
+      bin = column;
+      position = fraction / m_prob[column];
+    }
+  else
+    {
+      bin = m_alias[column];
+      position = (fraction - m_prob[column]) / (1 - m_prob[column]);
+    }
+
+  if (!m_interpolate)
+    {
+      return m_value[bin];
+    }
+  return m_lower[bin] + position * (m_value[bin] - m_lower[bin]);
+}
+
+uint32_t
+HttpEmpiricalRandomVariable::GetInteger (void)
+{
+  return static_cast<uint32_t> (GetValue ());
+}
+
+}
@@ -0,0 +1,119 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#ifndef HTTP_EMPIRICAL_RANDOM_VARIABLE_H_
+#define HTTP_EMPIRICAL_RANDOM_VARIABLE_H_
+
+#include "ns3/random-variable-stream.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup http
+ *
+ * RandomVariableStream drawing from an empirical CDF loaded from a file,
+ * to replace the Pries et al. distributions with ones measured from
+ * production logs. It fits any RandomVariableStream attribute of the
+ * HttpServer and HttpClient, e.g.:
+ * \code
+ *   httpServer.SetAttribute ("MainObjectSize",
+ *                            StringValue ("ns3::HttpEmpiricalRandomVariable[FileName=main-size.cdf]"));
+ * \endcode
+ *
+ * The file has one CDF point per line, in increasing value order, with
+ * the cumulative probability of the values up to it:
+ * \verbatim
+   value,cumulative probability
+   \endverbatim
+ * Empty lines and lines starting with '#' are skipped. The last point may
+ * have a probability below 1, the table is then normalized.
+ *
+ * Each point is a bin holding the probability mass between the previous
+ * point and itself. The bins are sampled with an alias table (Vose's
+ * method) built once when the file is loaded, so a sample costs a single
+ * uniform draw and two table lookups whatever the number of bins. With
+ * Interpolate the value is spread uniformly between the previous point and
+ * the point of the bin; without it the bin returns its point, for discrete
+ * distributions such as the number of inline objects.
+ */
+class HttpEmpiricalRandomVariable : public RandomVariableStream
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return type ID
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Constructor.
+   */
+  HttpEmpiricalRandomVariable ();
+
+  /**
+   * \brief Destructor.
+   */
+  virtual ~HttpEmpiricalRandomVariable ();
+
+  /**
+   * \brief Load a CDF file and build its alias table. Called when the
+   * FileName attribute is set; an empty name clears the table.
+   * \param fileName name of the CDF file.
+   */
+  void Load (std::string fileName);
+
+  /**
+   * \brief Get the number of bins of the table.
+   * \return the number of bins.
+   */
+  uint32_t GetNumBins (void) const;
+
+  /**
+   * \brief Draw a value from the empirical distribution.
+   * \return the value.
+   */
+  virtual double GetValue (void);
+
+  /**
+   * \brief Draw a value from the empirical distribution, rounded down.
+   * \return the value.
+   */
+  virtual uint32_t GetInteger (void);
+
+private:
+  /**
+   * \brief Build the alias table from the bin probabilities.
+   * \param probabilities probability of each bin, summing to 1.
+   */
+  void BuildAliasTable (const std::vector<double> &probabilities);
+
+  std::string m_fileName;        //!< Name of the CDF file loaded.
+  bool m_interpolate;            //!< True to spread the values over the bins.
+  std::vector<double> m_value;   //!< Point of each bin.
+  std::vector<double> m_lower;   //!< Previous point of each bin, the lower bound when interpolating.
+  std::vector<double> m_prob;    //!< Probability of keeping each alias table column's own bin.
+  std::vector<uint32_t> m_alias; //!< Bin taking the rest of each column.
+};
+
+}
+
+#endif /* HTTP_EMPIRICAL_RANDOM_VARIABLE_H_ */
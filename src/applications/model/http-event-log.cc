@@ -0,0 +1,235 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "http-event-log.h"
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HttpEventLog");
+
+NS_OBJECT_ENSURE_REGISTERED (HttpEventLog);
+
+namespace {
+
+const char EVENT_LOG_MAGIC[8] = { 'H', 'T', 'T', 'P', 'E', 'V', 'T', '1' };
+const uint32_t EVENT_LOG_VERSION = 1;
+
+}
+
+TypeId
+HttpEventLog::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HttpEventLog")
+    .SetParent<Object> ()
+    .AddConstructor<HttpEventLog> ()
+    .AddAttribute ("FileName",
+                   "Name of the file the events are written to.",
+                   StringValue ("http-events.bin"),
+                   MakeStringAccessor (&HttpEventLog::m_fileName),
+                   MakeStringChecker ())
+    .AddAttribute ("BufferSize",
+                   "Number of events buffered in memory, and written to the file in one block.",
+                   UintegerValue (65536),
+                   MakeUintegerAccessor (&HttpEventLog::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Overwrite",
+                   "Keep only the last BufferSize events in a ring, written when the "
+                   "simulation is destroyed, instead of writing every event.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&HttpEventLog::m_overwrite),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+HttpEventLog::HttpEventLog ()
+  : m_next (0),
+    m_wrapped (false),
+    m_count (0),
+    m_closed (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HttpEventLog::~HttpEventLog ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HttpEventLog::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  Object::DoDispose ();
+}
+
+uint64_t
+HttpEventLog::GetEventCount (void) const
+{
+  return m_count;
+}
+
+bool
+HttpEventLog::BufferFull (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_closed)
+    {
+      // Nothing would write the buffer any more.
+      NS_LOG_WARN ("HttpEventLog >> Events recorded after Close are dropped.");
+      return false;
+    }
+  if (m_events.empty ())
+    {
+      // First event: the buffer is allocated once, zeroed padding included.
+      Event zero;
+      std::memset (&zero, 0, sizeof (zero));
+      m_events.assign (m_bufferSize, zero);
+      Simulator::ScheduleDestroy (&HttpEventLog::Close, Ptr<HttpEventLog> (this));
+    }
+  else if (m_overwrite)
+    {
+      m_wrapped = true;
+    }
+  else
+    {
+      Write (&m_events[0], m_next);
+    }
+  m_next = 0;
+  return true;
+}
+
+void
+HttpEventLog::Write (const Event *events, uint32_t count)
+{
+  NS_LOG_FUNCTION (this << count);
+
+  if (!m_file.is_open ())
+    {
+      m_file.open (m_fileName.c_str (), std::ios::binary | std::ios::trunc);
+      NS_ABORT_MSG_IF (!m_file.is_open (), "HttpEventLog >> Can't open file " << m_fileName);
+      uint32_t header[2] = { EVENT_LOG_VERSION, sizeof (Event) };
+      m_file.write (EVENT_LOG_MAGIC, sizeof (EVENT_LOG_MAGIC));
+      m_file.write (reinterpret_cast<const char *> (header), sizeof (header));
+    }
+  m_file.write (reinterpret_cast<const char *> (events), count * sizeof (Event));
+}
+
+void
+HttpEventLog::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_closed)
+    {
+      return;
+    }
+  m_closed = true;
+
+  if (!m_events.empty ())
+    {
+      // The ring holds the oldest events after the next slot.
+      if (m_wrapped)
+        {
+          Write (&m_events[m_next], m_events.size () - m_next);
+        }
+      Write (&m_events[0], m_next);
+    }
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+      NS_LOG_INFO ("HttpEventLog >> " << m_count << " events recorded to " << m_fileName);
+    }
+  m_events.clear ();
+  m_next = 0;
+}
+
+const char *
+HttpEventLog::EventTypeToString (EventType type)
+{
+  switch (type)
+    {
+    case REQUEST_SENT:
+      return "request_sent";
+    case HEADER_RECEIVED:
+      return "header_received";
+    case BODY_PROGRESS:
+      return "body_progress";
+    case OBJECT_COMPLETE:
+      return "object_complete";
+    case PAGE_COMPLETE:
+      return "page_complete";
+    case PAGE_FAILED:
+      return "page_failed";
+    default:
+      return "unknown";
+    }
+}
+
+uint64_t
+HttpEventLog::DecodeToCsv (std::string fileName, std::string csvFileName)
+{
+  NS_LOG_FUNCTION (fileName << csvFileName);
+
+  std::ifstream in (fileName.c_str (), std::ios::binary);
+  NS_ABORT_MSG_IF (!in.is_open (), "HttpEventLog >> Can't open file " << fileName);
+  std::ofstream csv (csvFileName.c_str (), std::ios::trunc);
+  NS_ABORT_MSG_IF (!csv.is_open (), "HttpEventLog >> Can't open file " << csvFileName);
+
+  char magic[sizeof (EVENT_LOG_MAGIC)];
+  uint32_t header[2];
+  in.read (magic, sizeof (magic));
+  in.read (reinterpret_cast<char *> (header), sizeof (header));
+  NS_ABORT_MSG_IF (!in || std::memcmp (magic, EVENT_LOG_MAGIC, sizeof (magic)) != 0,
+                   "HttpEventLog >> " << fileName << " is not an event file.");
+  NS_ABORT_MSG_IF (header[0] != EVENT_LOG_VERSION || header[1] != sizeof (Event),
+                   "HttpEventLog >> " << fileName << ": unsupported version " << header[0]
+                   << " or record size " << header[1] << ".");
+
+  csv << "time_ns,node,session,page,connection,event,value\n";
+
+  // Decoding in blocks, so files larger than the RAM can be converted.
+  std::vector<Event> block (65536);
+  uint64_t count = 0;
+  while (in)
+    {
+      in.read (reinterpret_cast<char *> (&block[0]), block.size () * sizeof (Event));
+      uint32_t n = in.gcount () / sizeof (Event);
+      for (uint32_t i = 0; i < n; i++)
+        {
+          const Event &event = block[i];
+          csv << event.time << ',' << event.node << ',' << event.session << ','
+              << event.page << ',' << event.connection << ','
+              << EventTypeToString (static_cast<EventType> (event.type)) << ','
+              << event.value << '\n';
+        }
+      count += n;
+    }
+  return count;
+}
+
+}
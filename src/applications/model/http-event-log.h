@@ -0,0 +1,199 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#ifndef HTTP_EVENT_LOG_H_
+#define HTTP_EVENT_LOG_H_
+
+#include "ns3/object.h"
+#include "ns3/simulator.h"
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup http
+ *
+ * Binary recorder of the events of HttpClient applications, a cheap
+ * replacement for the NS_LOG output of the applications when many clients
+ * are traced. Each event is a fixed-size record stored in a preallocated
+ * buffer of BufferSize records. Nothing is formatted while the simulation
+ * runs: when the buffer is full it is written to FileName in one block.
+ * With Overwrite set the buffer is a ring instead, keeping only the last
+ * BufferSize events, which are written when the simulation is destroyed.
+ *
+ * File format (records in the byte order of the host):
+ * \verbatim
+   header     magic "HTTPEVT1" (8 bytes), version (u32), record size (u32)
+   record     time in ns (i64), node id (u32), session (u32), page id (u32),
+              connection (u32), value (u32), event type (u8), 3 bytes padding
+   \endverbatim
+ *
+ * DecodeToCsv turns a file into CSV, see also the http-event-decoder example.
+ *
+ * Typical use:
+ * \code
+ *   Ptr<HttpEventLog> log = CreateObject<HttpEventLog> ();
+ *   log->SetAttribute ("FileName", StringValue ("http-events.bin"));
+ *   httpClientHelper.SetAttribute ("EventLog", PointerValue (log));
+ * \endcode
+ */
+class HttpEventLog : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return type ID
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Constructor.
+   */
+  HttpEventLog ();
+
+  /**
+   * \brief Destructor.
+   */
+  virtual ~HttpEventLog ();
+
+  /**
+   * \brief Event types.
+   */
+  enum EventType
+  {
+    REQUEST_SENT = 0,  //!< A request was sent. Value: object number (0 for the main object).
+    HEADER_RECEIVED,   //!< A response header arrived. Value: content length.
+    BODY_PROGRESS,     //!< Response bytes arrived. Value: number of bytes.
+    OBJECT_COMPLETE,   //!< An object was completely received. Value: object size.
+    PAGE_COMPLETE,     //!< A web page was loaded. Value: page size.
+    PAGE_FAILED,       //!< A web page was abandoned after an error response. Value: bytes received.
+    NUM_EVENT_TYPES    //!< Number of event types.
+  };
+
+  /**
+   * \brief Event record, as stored in the buffer and the file.
+   */
+  struct Event
+  {
+    int64_t time;         //!< Simulation time in ns.
+    uint32_t node;        //!< Id of the node of the client.
+    uint32_t session;     //!< User session in the client.
+    uint32_t page;        //!< Page id in the session.
+    uint32_t connection;  //!< Connection of the session.
+    uint32_t value;       //!< Value, depending on the type.
+    uint8_t type;         //!< EventType.
+    uint8_t padding[3];   //!< Padding, 0.
+  };
+
+  /**
+   * \brief Record an event at the current simulation time.
+   * \param type the event type.
+   * \param node id of the node of the client.
+   * \param session user session in the client.
+   * \param page page id in the session.
+   * \param connection connection of the session.
+   * \param value value, depending on the type.
+   */
+  void Record (EventType type, uint32_t node, uint32_t session, uint32_t page,
+               uint32_t connection, uint32_t value);
+
+  /**
+   * \brief Get the number of events recorded.
+   * \return the number of events.
+   */
+  uint64_t GetEventCount (void) const;
+
+  /**
+   * \brief Write the buffered events and close the file. Called when the
+   * simulation is destroyed.
+   */
+  void Close (void);
+
+  /**
+   * \brief Convert an event file to CSV, one line per event.
+   * \param fileName name of the event file.
+   * \param csvFileName name of the CSV file to write.
+   * \return the number of events converted.
+   */
+  static uint64_t DecodeToCsv (std::string fileName, std::string csvFileName);
+
+  /**
+   * \brief Get the name of an event type.
+   * \param type the type.
+   * \return the name.
+   */
+  static const char *EventTypeToString (EventType type);
+
+protected:
+  /**
+   * \brief Dispose this object;
+   */
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Make room in the buffer: allocate it, write it to the file, or
+   * wrap around in ring mode.
+   * \return false if the log is closed and the event must be dropped.
+   */
+  bool BufferFull (void);
+
+  /**
+   * \brief Write events to the file, opening it first if needed.
+   * \param events the first event.
+   * \param count number of events.
+   */
+  void Write (const Event *events, uint32_t count);
+
+  std::string m_fileName;       //!< Name of the output file.
+  uint32_t m_bufferSize;        //!< Number of events of the buffer.
+  bool m_overwrite;             //!< True to keep only the last events, in a ring.
+  std::vector<Event> m_events;  //!< Event buffer.
+  uint32_t m_next;              //!< Index of the next event in the buffer.
+  bool m_wrapped;               //!< True once the ring has wrapped around.
+  uint64_t m_count;             //!< Number of events recorded.
+  std::ofstream m_file;         //!< Output file.
+  bool m_closed;                //!< True once Close was called.
+};
+
+inline void
+HttpEventLog::Record (EventType type, uint32_t node, uint32_t session, uint32_t page,
+                      uint32_t connection, uint32_t value)
+{
+  if (m_next == m_events.size () && !BufferFull ())
+    {
+      return;
+    }
+  Event &event = m_events[m_next++];
+  event.time = Simulator::Now ().GetNanoSeconds ();
+  event.node = node;
+  event.session = session;
+  event.page = page;
+  event.connection = connection;
+  event.value = value;
+  event.type = type;
+  m_count++;
+}
+
+}
+
+#endif /* HTTP_EVENT_LOG_H_ */
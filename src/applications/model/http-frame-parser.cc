@@ -0,0 +1,184 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "http-frame-parser.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HttpFrameParser");
+
+HttpFrameParser::HttpFrameParser ()
+  : m_state (FRAME_HEADER),
+    m_headerValid (false),
+    m_payloadReceived (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HttpFrameParser::Reset (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_state = FRAME_HEADER;
+  m_buf.clear ();
+  m_frame = HttpFrameHeader ();
+  m_payloadReceived = 0;
+}
+
+const HttpFrameHeader &
+HttpFrameParser::GetFrameHeader (void) const
+{
+  return m_frame;
+}
+
+const HttpHeader &
+HttpFrameParser::GetHeader (void) const
+{
+  return m_header;
+}
+
+bool
+HttpFrameParser::IsHeaderValid (void) const
+{
+  return m_headerValid;
+}
+
+bool
+HttpFrameParser::Parse (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet->GetSize ());
+
+  if (m_state == COMPLETE)
+    {
+      m_state = FRAME_HEADER;
+      m_payloadReceived = 0;
+    }
+
+  if (m_state == FRAME_HEADER)
+    {
+      if (packet->GetSize () == 0)
+        {
+          return false;
+        }
+      ParseFrameHeader (packet);
+      if (m_state == FRAME_HEADER)
+        {
+          return false;
+        }
+    }
+
+  if (m_frame.GetType () == HttpFrameHeader::HEADERS)
+    {
+      if (packet->GetSize () == 0)
+        {
+          return false;
+        }
+      ParseHeaderBlock (packet);
+    }
+  else
+    {
+      uint32_t payloadBytes = std::min (packet->GetSize (), m_frame.GetLength () - m_payloadReceived);
+      packet->RemoveAtStart (payloadBytes);
+      m_payloadReceived += payloadBytes;
+    }
+
+  if (m_payloadReceived == m_frame.GetLength ())
+    {
+      m_state = COMPLETE;
+      return true;
+    }
+  return false;
+}
+
+void
+HttpFrameParser::ParseFrameHeader (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_buf.empty () && packet->GetSize () >= HttpFrameHeader::SIZE)
+    {
+      // Common case: the whole frame header is in the packet.
+      packet->RemoveHeader (m_frame);
+    }
+  else
+    {
+      // Reassembling a frame header split over several segments.
+      uint32_t offset = m_buf.size ();
+      uint32_t size = std::min (packet->GetSize (), HttpFrameHeader::SIZE - offset);
+      m_buf.resize (offset + size);
+      packet->CopyData (&m_buf[offset], size);
+      packet->RemoveAtStart (size);
+      if (m_buf.size () < HttpFrameHeader::SIZE)
+        {
+          return;
+        }
+      Ptr<Packet> frame = Create<Packet> (&m_buf[0], m_buf.size ());
+      frame->RemoveHeader (m_frame);
+      m_buf.clear ();
+    }
+
+  NS_LOG_LOGIC ("HttpFrameParser >> " << m_frame);
+  m_payloadReceived = 0;
+  m_state = PAYLOAD;
+}
+
+void
+HttpFrameParser::ParseHeaderBlock (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t length = m_frame.GetLength ();
+  uint32_t consumed;
+  if (m_buf.empty () && packet->GetSize () >= length)
+    {
+      // Common case: the whole header block is in the packet and is parsed
+      // in place, from a fragment so it cannot run into the next frames.
+      consumed = packet->CreateFragment (0, length)->PeekHeader (m_header);
+      packet->RemoveAtStart (length);
+    }
+  else
+    {
+      // Reassembling a header block split over several segments.
+      uint32_t offset = m_buf.size ();
+      uint32_t size = std::min (packet->GetSize (), length - offset);
+      m_buf.resize (offset + size);
+      packet->CopyData (&m_buf[offset], size);
+      packet->RemoveAtStart (size);
+      m_payloadReceived = m_buf.size ();
+      if (m_buf.size () < length)
+        {
+          return;
+        }
+      consumed = m_header.Parse (&m_buf[0], m_buf.size ());
+      m_buf.clear ();
+    }
+
+  m_payloadReceived = length;
+  m_headerValid = m_header.GetParseStatus () == HttpHeader::PARSE_OK && consumed == length;
+  if (!m_headerValid)
+    {
+      NS_LOG_ERROR ("HttpFrameParser >> Malformed header block on stream "
+                    << m_frame.GetStreamId () << " (status " << m_header.GetParseStatus ()
+                    << ", " << consumed << " of " << length << " bytes parsed).");
+    }
+}
+
+}
@@ -0,0 +1,123 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#ifndef HTTP_FRAME_PARSER_H_
+#define HTTP_FRAME_PARSER_H_
+
+#include "ns3/packet.h"
+#include "ns3/http-header.h"
+#include "ns3/http-frame-header.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup http
+ *
+ * Incremental parser of the frames of the multiplexed HTTP transport (see
+ * HttpFrameHeader) carried by a TCP byte stream. Frame headers and the
+ * header blocks of HEADERS frames may be split over any number of
+ * segments. The payload of DATA frames is only counted.
+ *
+ * Typical use:
+ * \code
+ *   while (parser.Parse (packet))
+ *     {
+ *       const HttpFrameHeader &frame = parser.GetFrameHeader ();
+ *       // the frame is complete
+ *     }
+ * \endcode
+ */
+class HttpFrameParser
+{
+public:
+  /**
+   * \brief Constructor.
+   */
+  HttpFrameParser ();
+
+  /**
+   * \brief Consume bytes from the front of a packet.
+   *
+   * Bytes are removed from the packet until either the current frame is
+   * complete or the packet is empty.
+   *
+   * \param packet received bytes.
+   * \return true if a frame was completed. The packet may then still hold
+   * bytes of the following frames.
+   */
+  bool Parse (Ptr<Packet> packet);
+
+  /**
+   * \brief Get the frame header of the last completed frame.
+   * \return the frame header.
+   */
+  const HttpFrameHeader &GetFrameHeader (void) const;
+
+  /**
+   * \brief Get the header block of the last completed HEADERS frame.
+   * \return the HTTP header.
+   */
+  const HttpHeader &GetHeader (void) const;
+
+  /**
+   * \brief Check the header block of the last completed HEADERS frame.
+   * \return true if it is a complete HTTP header filling exactly the frame.
+   */
+  bool IsHeaderValid (void) const;
+
+  /**
+   * \brief Drop any partially received frame.
+   */
+  void Reset (void);
+
+private:
+  /**
+   * \brief Consume bytes until the frame header has been parsed.
+   * \param packet received bytes.
+   */
+  void ParseFrameHeader (Ptr<Packet> packet);
+
+  /**
+   * \brief Consume bytes of a header block until it is complete.
+   * \param packet received bytes.
+   */
+  void ParseHeaderBlock (Ptr<Packet> packet);
+
+  /**
+   * \brief Parser states.
+   */
+  enum State
+  {
+    FRAME_HEADER,  //!< Waiting for the end of the frame header.
+    PAYLOAD,       //!< Receiving the frame payload.
+    COMPLETE       //!< The frame is complete.
+  };
+
+  State m_state;                //!< Current state.
+  std::vector<uint8_t> m_buf;   //!< Reassembly buffer of the frame header or header block.
+  HttpFrameHeader m_frame;      //!< Header of the current frame.
+  HttpHeader m_header;          //!< Header block of the last HEADERS frame.
+  bool m_headerValid;           //!< True if the last header block was valid.
+  uint32_t m_payloadReceived;   //!< Payload bytes of the current frame received so far.
+};
+
+}
+
+#endif /* HTTP_FRAME_PARSER_H_ */
@@ -0,0 +1,220 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "http-latency-histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HttpLatencyHistogram");
+
+namespace {
+
+/**
+ * \brief Get the position of the most significant bit set in a value.
+ * \param value a value greater than zero.
+ * \return the bit position, from 0 to 63.
+ */
+uint32_t
+MostSignificantBit (uint64_t value)
+{
+  uint32_t bit = 0;
+  for (uint32_t shift = 32; shift > 0; shift >>= 1)
+    {
+      if (value >> shift)
+        {
+          value >>= shift;
+          bit += shift;
+        }
+    }
+  return bit;
+}
+
+} // anonymous namespace
+
+HttpLatencyHistogram::HttpLatencyHistogram (uint32_t precision)
+  : m_precision (precision),
+    m_count (0),
+    m_min (0),
+    m_max (0),
+    m_sum (0)
+{
+  NS_LOG_FUNCTION (this << precision);
+  NS_ABORT_MSG_IF (precision < 1 || precision > 16, "HttpLatencyHistogram >> Precision must be between 1 and 16.");
+}
+
+void
+HttpLatencyHistogram::Record (Time delay)
+{
+  int64_t us = delay.GetMicroSeconds ();
+  uint64_t value = us > 0 ? us : 0;
+
+  uint32_t index = GetIndex (value);
+  if (index >= m_counts.size ())
+    {
+      m_counts.resize (index + 1, 0);
+    }
+  m_counts[index]++;
+
+  if (m_count == 0 || value < m_min)
+    {
+      m_min = value;
+    }
+  if (value > m_max)
+    {
+      m_max = value;
+    }
+  m_count++;
+  m_sum += value;
+}
+
+void
+HttpLatencyHistogram::Merge (const HttpLatencyHistogram &other)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (other.m_precision != m_precision, "HttpLatencyHistogram >> Cannot merge histograms of different precision.");
+
+  if (other.m_count == 0)
+    {
+      return;
+    }
+
+  if (other.m_counts.size () > m_counts.size ())
+    {
+      m_counts.resize (other.m_counts.size (), 0);
+    }
+  for (uint32_t i = 0; i < other.m_counts.size (); i++)
+    {
+      m_counts[i] += other.m_counts[i];
+    }
+
+  m_min = m_count == 0 ? other.m_min : std::min (m_min, other.m_min);
+  m_max = std::max (m_max, other.m_max);
+  m_count += other.m_count;
+  m_sum += other.m_sum;
+}
+
+void
+HttpLatencyHistogram::Reset (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_counts.clear ();
+  m_count = 0;
+  m_min = 0;
+  m_max = 0;
+  m_sum = 0;
+}
+
+uint64_t
+HttpLatencyHistogram::GetCount (void) const
+{
+  return m_count;
+}
+
+Time
+HttpLatencyHistogram::GetMin (void) const
+{
+  return MicroSeconds (m_min);
+}
+
+Time
+HttpLatencyHistogram::GetMax (void) const
+{
+  return MicroSeconds (m_max);
+}
+
+Time
+HttpLatencyHistogram::GetMean (void) const
+{
+  if (m_count == 0)
+    {
+      return Time (0);
+    }
+  return MicroSeconds (static_cast<uint64_t> (m_sum / m_count));
+}
+
+Time
+HttpLatencyHistogram::GetPercentile (double percentile) const
+{
+  if (m_count == 0)
+    {
+      return Time (0);
+    }
+
+  // Rank of the sample that has the given percentage of samples at or below it.
+  uint64_t rank = static_cast<uint64_t> (std::ceil (std::min (std::max (percentile, 0.0), 100.0) / 100.0 * m_count));
+  rank = std::max (rank, static_cast<uint64_t> (1));
+
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < m_counts.size (); i++)
+    {
+      seen += m_counts[i];
+      if (seen >= rank)
+        {
+          return MicroSeconds (std::min (std::max (GetValue (i), m_min), m_max));
+        }
+    }
+  return MicroSeconds (m_max);
+}
+
+uint32_t
+HttpLatencyHistogram::GetPrecision (void) const
+{
+  return m_precision;
+}
+
+uint32_t
+HttpLatencyHistogram::GetIndex (uint64_t value) const
+{
+  uint64_t linear = 1ULL << m_precision;
+  if (value < linear)
+    {
+      return value;
+    }
+
+  // Keeping the m_precision most significant bits of the value.
+  uint64_t half = linear >> 1;
+  uint32_t bit = MostSignificantBit (value);
+  uint32_t shift = bit - m_precision + 1;
+  uint64_t sub = value >> shift;
+  return linear + (bit - m_precision) * half + (sub - half);
+}
+
+uint64_t
+HttpLatencyHistogram::GetValue (uint32_t index) const
+{
+  uint64_t linear = 1ULL << m_precision;
+  if (index < linear)
+    {
+      return index;
+    }
+
+  uint64_t half = linear >> 1;
+  uint64_t offset = index - linear;
+  uint32_t bit = m_precision + offset / half;
+  uint64_t sub = half + offset % half;
+  uint32_t shift = bit - m_precision + 1;
+  uint64_t width = 1ULL << shift;
+  return (sub << shift) + (width - 1) / 2;
+}
+
+}
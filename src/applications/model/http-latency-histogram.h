@@ -0,0 +1,132 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#ifndef HTTP_LATENCY_HISTOGRAM_H_
+#define HTTP_LATENCY_HISTOGRAM_H_
+
+#include "ns3/nstime.h"
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup http
+ *
+ * Histogram of delays with log-scaled buckets, in the style of HDR
+ * histograms. Delays are recorded with microsecond resolution. Values
+ * below 2^precision microseconds have a bucket each; every power of two
+ * above that is split into 2^(precision-1) buckets of equal width, so
+ * the relative error of a reported percentile is below 2^-precision.
+ *
+ * Memory does not depend on the number of samples: the bucket array
+ * only grows up to the largest delay recorded. With the default precision
+ * of 7 (error below 0.8%), delays up to 100 seconds fit in about 1500
+ * buckets. Histograms with the same precision can be merged.
+ */
+class HttpLatencyHistogram
+{
+public:
+  /**
+   * \brief Constructor.
+   * \param precision number of significant bits kept for each value (1 to 16).
+   */
+  HttpLatencyHistogram (uint32_t precision = 7);
+
+  /**
+   * \brief Record a delay.
+   * \param delay the delay. Negative delays are recorded as zero.
+   */
+  void Record (Time delay);
+
+  /**
+   * \brief Add the samples of another histogram to this one.
+   * \param other histogram with the same precision.
+   */
+  void Merge (const HttpLatencyHistogram &other);
+
+  /**
+   * \brief Remove all samples.
+   */
+  void Reset (void);
+
+  /**
+   * \brief Get the number of recorded samples.
+   * \return the number of samples.
+   */
+  uint64_t GetCount (void) const;
+
+  /**
+   * \brief Get the smallest recorded delay.
+   * \return the minimum, or zero if there are no samples.
+   */
+  Time GetMin (void) const;
+
+  /**
+   * \brief Get the largest recorded delay.
+   * \return the maximum, or zero if there are no samples.
+   */
+  Time GetMax (void) const;
+
+  /**
+   * \brief Get the mean of the recorded delays.
+   * \return the mean, or zero if there are no samples.
+   */
+  Time GetMean (void) const;
+
+  /**
+   * \brief Get a percentile of the recorded delays.
+   * \param percentile the percentile, from 0 to 100 (e.g. 99.9).
+   * \return the delay below which the given percentage of samples fall,
+   * or zero if there are no samples.
+   */
+  Time GetPercentile (double percentile) const;
+
+  /**
+   * \brief Get the precision of the histogram.
+   * \return number of significant bits kept for each value.
+   */
+  uint32_t GetPrecision (void) const;
+
+private:
+  /**
+   * \brief Get the bucket of a value.
+   * \param value value in microseconds.
+   * \return the bucket index.
+   */
+  uint32_t GetIndex (uint64_t value) const;
+
+  /**
+   * \brief Get the value reported for a bucket.
+   * \param index the bucket index.
+   * \return the middle of the bucket, in microseconds.
+   */
+  uint64_t GetValue (uint32_t index) const;
+
+  uint32_t m_precision;           //!< Number of significant bits kept for each value.
+  std::vector<uint64_t> m_counts; //!< Number of samples in each bucket.
+  uint64_t m_count;               //!< Total number of samples.
+  uint64_t m_min;                 //!< Smallest sample, in microseconds.
+  uint64_t m_max;                 //!< Largest sample, in microseconds.
+  double m_sum;                   //!< Sum of the samples, in microseconds.
+};
+
+}
+
+#endif /* HTTP_LATENCY_HISTOGRAM_H_ */
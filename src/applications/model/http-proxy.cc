@@ -0,0 +1,633 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/packet.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/http-workload-trace.h"
+#include <algorithm>
+
+#include "http-proxy.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HttpProxyApplication");
+
+TypeId
+HttpProxy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HttpProxy")
+    .SetParent<Application> ()
+    .AddConstructor<HttpProxy> ()
+    .AddAttribute ("Port",
+                   "Port on which we listen for client connections.",
+                   UintegerValue (80),
+                   MakeUintegerAccessor (&HttpProxy::m_port),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("UpstreamAddress",
+                   "The address of the server the misses are forwarded to.",
+                   AddressValue (),
+                   MakeAddressAccessor (&HttpProxy::m_upstreamAddress),
+                   MakeAddressChecker ())
+    .AddAttribute ("UpstreamPort",
+                   "The port of the server the misses are forwarded to.",
+                   UintegerValue (80),
+                   MakeUintegerAccessor (&HttpProxy::m_upstreamPort),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("CacheSize",
+                   "Capacity of the cache, in body bytes. 0 disables caching.",
+                   UintegerValue (100000000),
+                   MakeUintegerAccessor (&HttpProxy::m_cacheSize),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("MaxUpstreamConnections",
+                   "Maximum number of persistent connections to the server.",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&HttpProxy::m_maxUpstreamConnections),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddTraceSource ("HitRatio",
+                     "Fraction of the cacheable requests served from the cache.",
+                     MakeTraceSourceAccessor (&HttpProxy::m_hitRatio),
+                     "ns3::TracedValueCallback::Double")
+    .AddTraceSource ("ByteHitRatio",
+                     "Fraction of the cacheable body bytes served from the cache.",
+                     MakeTraceSourceAccessor (&HttpProxy::m_byteHitRatio),
+                     "ns3::TracedValueCallback::Double")
+    .AddTraceSource ("OriginConnections",
+                     "Number of connections open to the server.",
+                     MakeTraceSourceAccessor (&HttpProxy::m_originConnections),
+                     "ns3::TracedValueCallback::Uint32")
+  ;
+  return tid;
+}
+
+HttpProxy::HttpProxy ()
+{
+  NS_LOG_FUNCTION (this);
+
+  m_socket = 0;
+  m_cacheBytes = 0;
+  m_hits = 0;
+  m_misses = 0;
+  m_hitBytes = 0;
+  m_missBytes = 0;
+  m_originConnectionsOpened = 0;
+  m_hitRatio = 0;
+  m_byteHitRatio = 0;
+  m_originConnections = 0;
+}
+
+HttpProxy::~HttpProxy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HttpProxy::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_clients.clear ();
+  m_upstreams.clear ();
+  m_lru.clear ();
+  m_cacheIndex.clear ();
+  Application::DoDispose ();
+}
+
+uint64_t
+HttpProxy::GetHits (void) const
+{
+  return m_hits;
+}
+
+uint64_t
+HttpProxy::GetMisses (void) const
+{
+  return m_misses;
+}
+
+uint32_t
+HttpProxy::GetOriginConnectionsOpened (void) const
+{
+  return m_originConnectionsOpened;
+}
+
+void
+HttpProxy::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Sized once, so that references to the connections stay valid.
+  m_upstreams.resize (m_maxUpstreamConnections);
+
+  if (!m_socket)
+    {
+      TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
+
+      m_socket = Socket::CreateSocket (GetNode (), tid);
+
+      // Fatal error if socket type is not NS3_SOCK_STREAM or NS3_SOCK_SEQPACKET
+      if (m_socket->GetSocketType () != Socket::NS3_SOCK_STREAM &&
+          m_socket->GetSocketType () != Socket::NS3_SOCK_SEQPACKET)
+        {
+          NS_FATAL_ERROR ("Using HttpProxy with an incompatible socket type. "
+                          "HttpProxy requires SOCK_STREAM or SOCK_SEQPACKET. "
+                          "In other words, use TCP instead of UDP.");
+        }
+
+      InetSocketAddress local = InetSocketAddress (Ipv4Address::GetAny (), m_port);
+      m_socket->Bind (local);
+      m_socket->Listen ();
+      m_socket->SetAcceptCallback (MakeCallback (&HttpProxy::HandleRequest, this),
+                                   MakeCallback (&HttpProxy::HandleAccept, this));
+    }
+}
+
+void
+HttpProxy::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_socket != 0)
+    {
+      m_socket->Close ();
+    }
+  else
+    {
+      NS_LOG_WARN ("HttpProxyApplication found null socket to close in StopApplication");
+    }
+
+  for (uint32_t i = 0; i < m_upstreams.size (); i++)
+    {
+      UpstreamConnection &upstream = m_upstreams[i];
+      if (upstream.socket != 0)
+        {
+          upstream.socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+          upstream.socket->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (),
+                                              MakeNullCallback<void, Ptr<Socket> > ());
+          upstream.socket->Close ();
+        }
+      upstream = UpstreamConnection ();
+    }
+  m_originConnections = 0;
+
+  NS_LOG_INFO ("HttpProxy >> " << m_hits << " hits, " << m_misses << " misses, "
+               << m_originConnectionsOpened << " connections opened to the server.");
+}
+
+
+bool
+HttpProxy::HandleRequest (Ptr<Socket> s, const Address& address)
+{
+  NS_LOG_FUNCTION (this << s << address);
+  NS_LOG_DEBUG ("HttpProxy >> Request for connection from " << InetSocketAddress::ConvertFrom (address).GetIpv4 () << " received.");
+  return true;
+}
+
+
+void
+HttpProxy::HandleAccept (Ptr<Socket> s, const Address& address)
+{
+  NS_LOG_FUNCTION (this << s << address);
+
+  ClientConnection &client = m_clients[s];
+  client.socket = s;
+  client.peer = InetSocketAddress::ConvertFrom (address).GetIpv4 ();
+
+  UintegerValue bufSizeValue;
+  s->GetAttribute ("SndBufSize", bufSizeValue);
+  client.sendQueue.SetSocket (s, bufSizeValue.Get ());
+
+  NS_LOG_DEBUG ("HttpProxy >> Connection with Client (" << client.peer << ") successfully established!");
+  s->SetRecvCallback (MakeCallback (&HttpProxy::HandleClientReceive, this));
+  s->SetSendCallback (MakeCallback (&HttpProxy::HandleClientSend, this));
+  s->SetCloseCallbacks (MakeCallback (&HttpProxy::HandleClientClose, this),
+                        MakeCallback (&HttpProxy::HandleClientClose, this));
+}
+
+
+void
+HttpProxy::HandleClientClose (Ptr<Socket> s)
+{
+  NS_LOG_FUNCTION (this << s);
+  // Fetches still running for this client only fill the cache.
+  m_clients.erase (s);
+}
+
+
+void
+HttpProxy::HandleClientReceive (Ptr<Socket> s)
+{
+  NS_LOG_FUNCTION (this << s);
+
+  std::map<Ptr<Socket>, ClientConnection>::iterator it = m_clients.find (s);
+  NS_ASSERT_MSG (it != m_clients.end (), "HttpProxy >> Data received on an unknown connection.");
+  ClientConnection &client = it->second;
+
+  Ptr<Packet> packet;
+  while ((packet = s->Recv ()))
+    {
+      if (packet->GetSize () == 0)
+        { //EOF
+          break;
+        }
+
+      while (client.parser.Parse (packet))
+        {
+          ServeRequest (client, client.parser.GetHeader ());
+        }
+    }
+}
+
+
+void
+HttpProxy::HandleClientSend (Ptr<Socket> s, uint32_t available)
+{
+  NS_LOG_FUNCTION (this << s << available);
+
+  std::map<Ptr<Socket>, ClientConnection>::iterator it = m_clients.find (s);
+  if (it != m_clients.end ())
+    {
+      it->second.sendQueue.Push ();
+    }
+}
+
+
+void
+HttpProxy::ServeRequest (ClientConnection &client, const HttpHeader &request)
+{
+  NS_LOG_FUNCTION (this << client.socket);
+
+  Fetch fetch;
+  fetch.client = client.socket;
+  fetch.url = request.GetUrl ();
+  fetch.response = client.sendQueue.Reserve ();
+
+  // Only page URLs name the same object every time. The other ones are
+  // answered with a new random object by the server.
+  uint64_t page;
+  uint32_t object;
+  bool mainObject;
+  fetch.cacheable = m_cacheSize > 0
+    && HttpWorkloadTrace::ParseUrl (fetch.url, page, object, mainObject);
+
+  if (fetch.cacheable)
+    {
+      const CacheEntry *entry = Lookup (fetch.url);
+      if (entry != 0)
+        {
+          NS_LOG_INFO ("HttpProxy >> Client (" << client.peer << ") requesting a "
+                       << fetch.url << ". Served from the cache.");
+          RecordAccess (true, entry->contentLength);
+          Respond (client.socket, fetch.response, *entry, "200", "OK");
+          return;
+        }
+    }
+
+  NS_LOG_INFO ("HttpProxy >> Client (" << client.peer << ") requesting a "
+               << fetch.url << ". Forwarded to the server.");
+  Forward (fetch);
+}
+
+
+void
+HttpProxy::Respond (Ptr<Socket> s, uint64_t response, const CacheEntry &entry,
+                    const std::string &statusCode, const std::string &phrase)
+{
+  NS_LOG_FUNCTION (this << s << entry.url);
+
+  std::map<Ptr<Socket>, ClientConnection>::iterator it = m_clients.find (s);
+  if (it == m_clients.end ())
+    {
+      NS_LOG_DEBUG ("HttpProxy >> Client closed the connection before " << entry.url << " arrived.");
+      return;
+    }
+
+  HttpHeader httpHeaderOut;
+  httpHeaderOut.SetRequest (false);
+  httpHeaderOut.SetVersion ("HTTP/1.1");
+  httpHeaderOut.SetStatusCode (statusCode);
+  httpHeaderOut.SetPhrase (phrase);
+  httpHeaderOut.SetContentLength (entry.contentLength);
+  httpHeaderOut.SetContentType (entry.contentType);
+  httpHeaderOut.SetNumOfInlineObjects (entry.numOfInlineObjects);
+
+  HttpSendQueue &sendQueue = it->second.sendQueue;
+  sendQueue.Fill (response, httpHeaderOut, entry.contentLength);
+  sendQueue.Push ();
+}
+
+
+const HttpProxy::CacheEntry *
+HttpProxy::Lookup (const std::string &url)
+{
+  std::map<std::string, std::list<CacheEntry>::iterator>::iterator it = m_cacheIndex.find (url);
+  if (it == m_cacheIndex.end ())
+    {
+      return 0;
+    }
+  m_lru.splice (m_lru.begin (), m_lru, it->second);
+  return &*it->second;
+}
+
+
+void
+HttpProxy::Insert (const CacheEntry &entry)
+{
+  NS_LOG_FUNCTION (this << entry.url << entry.contentLength);
+
+  if (entry.contentLength > m_cacheSize || Lookup (entry.url) != 0)
+    {
+      // Too large to be cached, or already fetched for another client.
+      return;
+    }
+
+  while (m_cacheBytes + entry.contentLength > m_cacheSize)
+    {
+      const CacheEntry &victim = m_lru.back ();
+      NS_LOG_DEBUG ("HttpProxy >> Evicting " << victim.url << " (" << victim.contentLength << " bytes).");
+      m_cacheBytes -= victim.contentLength;
+      m_cacheIndex.erase (victim.url);
+      m_lru.pop_back ();
+    }
+
+  m_lru.push_front (entry);
+  m_cacheIndex[entry.url] = m_lru.begin ();
+  m_cacheBytes += entry.contentLength;
+}
+
+
+void
+HttpProxy::RecordAccess (bool hit, uint32_t size)
+{
+  if (hit)
+    {
+      m_hits++;
+      m_hitBytes += size;
+    }
+  else
+    {
+      m_misses++;
+      m_missBytes += size;
+    }
+  m_hitRatio = double (m_hits) / (m_hits + m_misses);
+  if (m_hitBytes + m_missBytes > 0)
+    {
+      m_byteHitRatio = double (m_hitBytes) / (m_hitBytes + m_missBytes);
+    }
+}
+
+
+void
+HttpProxy::Forward (const Fetch &fetch)
+{
+  NS_LOG_FUNCTION (this << fetch.url);
+
+  // The least loaded open connection, or an unused slot.
+  uint32_t best = m_upstreams.size ();
+  uint32_t unused = m_upstreams.size ();
+  for (uint32_t i = 0; i < m_upstreams.size (); i++)
+    {
+      if (m_upstreams[i].socket == 0)
+        {
+          unused = std::min (unused, i);
+        }
+      else if (best == m_upstreams.size ()
+               || m_upstreams[i].fetches.size () < m_upstreams[best].fetches.size ())
+        {
+          best = i;
+        }
+    }
+
+  // Open a new connection rather than queue behind a busy one.
+  if (unused < m_upstreams.size ()
+      && (best == m_upstreams.size () || !m_upstreams[best].fetches.empty ()))
+    {
+      best = OpenUpstreamConnection ();
+    }
+
+  UpstreamConnection &upstream = m_upstreams[best];
+  upstream.fetches.push_back (fetch);
+  if (upstream.connected)
+    {
+      SendUpstreamRequest (upstream, fetch.url);
+    }
+}
+
+
+uint32_t
+HttpProxy::OpenUpstreamConnection (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t index = 0;
+  while (m_upstreams[index].socket != 0)
+    {
+      index++;
+    }
+  NS_ASSERT (index < m_upstreams.size ());
+
+  TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
+
+  UpstreamConnection &upstream = m_upstreams[index];
+  upstream = UpstreamConnection ();
+  upstream.socket = Socket::CreateSocket (GetNode (), tid);
+
+  if (Ipv4Address::IsMatchingType (m_upstreamAddress) == true)
+    {
+      upstream.socket->Bind ();
+      upstream.socket->Connect (InetSocketAddress (Ipv4Address::ConvertFrom (m_upstreamAddress), m_upstreamPort));
+    }
+  else if (Ipv6Address::IsMatchingType (m_upstreamAddress) == true)
+    {
+      upstream.socket->Bind6 ();
+      upstream.socket->Connect (Inet6SocketAddress (Ipv6Address::ConvertFrom (m_upstreamAddress), m_upstreamPort));
+    }
+
+  upstream.socket->SetConnectCallback (MakeCallback (&HttpProxy::UpstreamConnectionSucceeded, this),
+                                       MakeCallback (&HttpProxy::UpstreamConnectionFailed, this));
+  upstream.socket->SetRecvCallback (MakeCallback (&HttpProxy::HandleUpstreamReceive, this));
+  upstream.socket->SetCloseCallbacks (MakeCallback (&HttpProxy::HandleUpstreamClose, this),
+                                      MakeCallback (&HttpProxy::HandleUpstreamClose, this));
+
+  m_originConnectionsOpened++;
+  m_originConnections = m_originConnections + 1;
+  NS_LOG_DEBUG ("HttpProxy >> Opening connection " << index << " to the server.");
+  return index;
+}
+
+
+HttpProxy::UpstreamConnection *
+HttpProxy::FindUpstream (Ptr<Socket> socket)
+{
+  for (uint32_t i = 0; i < m_upstreams.size (); i++)
+    {
+      if (m_upstreams[i].socket == socket)
+        {
+          return &m_upstreams[i];
+        }
+    }
+  return 0;
+}
+
+
+void
+HttpProxy::UpstreamConnectionSucceeded (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+
+  UpstreamConnection *upstream = FindUpstream (socket);
+  NS_ASSERT_MSG (upstream != 0, "HttpProxy >> Unknown connection to the server.");
+  upstream->connected = true;
+  NS_LOG_DEBUG ("HttpProxy >> Connection with the server successfully established!");
+
+  // Requests queued while the connection was being set up.
+  for (std::deque<Fetch>::const_iterator it = upstream->fetches.begin ();
+       it != upstream->fetches.end (); ++it)
+    {
+      SendUpstreamRequest (*upstream, it->url);
+    }
+}
+
+
+void
+HttpProxy::UpstreamConnectionFailed (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+
+  UpstreamConnection *upstream = FindUpstream (socket);
+  if (upstream == 0)
+    {
+      return;
+    }
+
+  NS_LOG_ERROR ("HttpProxy >> Server did not accept the connection request, answering "
+                << upstream->fetches.size () << " requests with 502.");
+  std::deque<Fetch> fetches;
+  fetches.swap (upstream->fetches);
+  *upstream = UpstreamConnection ();
+  m_originConnections = m_originConnections - 1;
+
+  // Not forwarded again: an unreachable server would fail every retry.
+  for (std::deque<Fetch>::const_iterator it = fetches.begin (); it != fetches.end (); ++it)
+    {
+      uint64_t page;
+      uint32_t object;
+      bool mainObject;
+      if (!HttpWorkloadTrace::ParseUrl (it->url, page, object, mainObject))
+        {
+          mainObject = it->url == "main/object";
+        }
+
+      CacheEntry entry;
+      entry.url = it->url;
+      entry.contentLength = 0;
+      entry.contentType = mainObject ? HttpHeader::MAIN_OBJECT : HttpHeader::INLINE_OBJECT;
+      entry.numOfInlineObjects = 0;
+      Respond (it->client, it->response, entry, "502", "Bad Gateway");
+    }
+}
+
+
+void
+HttpProxy::SendUpstreamRequest (UpstreamConnection &upstream, const std::string &url)
+{
+  NS_LOG_FUNCTION (this << url);
+
+  m_httpHeader.SetRequest (true);
+  m_httpHeader.SetMethod ("GET");
+  m_httpHeader.SetUrl (url);
+  m_httpHeader.SetVersion ("HTTP/1.1");
+
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (m_httpHeader);
+  upstream.socket->Send (packet);
+}
+
+
+void
+HttpProxy::HandleUpstreamReceive (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+
+  UpstreamConnection *upstream = FindUpstream (socket);
+  NS_ASSERT_MSG (upstream != 0, "HttpProxy >> Data received on an unknown connection.");
+
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      if (packet->GetSize () == 0)
+        { //EOF
+          break;
+        }
+
+      // The server answers the pipelined requests in order.
+      while (upstream->parser.Parse (packet))
+        {
+          NS_ASSERT_MSG (!upstream->fetches.empty (), "HttpProxy >> Response without a request.");
+          Fetch fetch = upstream->fetches.front ();
+          upstream->fetches.pop_front ();
+
+          const HttpHeader &response = upstream->parser.GetHeader ();
+          CacheEntry entry;
+          entry.url = fetch.url;
+          entry.contentLength = response.GetContentLength ();
+          entry.contentType = response.GetContentType ();
+          entry.numOfInlineObjects = response.GetNumOfInlineObjects ();
+
+          // Errors, such as the 503 of an overloaded server, are passed on
+          // but neither cached nor counted.
+          if (fetch.cacheable && response.GetStatusCode () == "200")
+            {
+              RecordAccess (false, entry.contentLength);
+              Insert (entry);
+            }
+          Respond (fetch.client, fetch.response, entry, response.GetStatusCode (), response.GetPhrase ());
+        }
+    }
+}
+
+
+void
+HttpProxy::HandleUpstreamClose (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+
+  UpstreamConnection *upstream = FindUpstream (socket);
+  if (upstream == 0)
+    {
+      return;
+    }
+
+  NS_LOG_DEBUG ("HttpProxy >> Server closed a connection with "
+                << upstream->fetches.size () << " requests pending.");
+  std::deque<Fetch> fetches;
+  fetches.swap (upstream->fetches);
+  *upstream = UpstreamConnection ();
+  m_originConnections = m_originConnections - 1;
+
+  for (std::deque<Fetch>::const_iterator it = fetches.begin (); it != fetches.end (); ++it)
+    {
+      Forward (*it);
+    }
+}
+
+}
@@ -0,0 +1,287 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#ifndef HTTP_PROXY_H_
+#define HTTP_PROXY_H_
+
+#include "ns3/application.h"
+#include "ns3/socket.h"
+#include "ns3/address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/traced-value.h"
+#include "ns3/http-header.h"
+#include "ns3/http-stream-parser.h"
+#include "ns3/http-send-queue.h"
+#include <map>
+#include <list>
+#include <deque>
+#include <vector>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup http
+ *
+ * Caching proxy between HttpClient and HttpServer applications, to study
+ * how much an edge cache cuts the origin load and the page load time.
+ *
+ * The proxy accepts client connections like an HttpServer. Requests for
+ * the pages of a catalog or workload trace (URLs that name a page, see
+ * HttpWorkloadTrace::ParseUrl) are served from an LRU cache limited to
+ * CacheSize body bytes, keyed by URL. Misses, and requests for other URLs,
+ * which name a new object every time, are forwarded to the upstream server
+ * over a pool of up to MaxUpstreamConnections persistent, pipelined
+ * connections. Responses are returned to each client in request order.
+ *
+ * The hit ratio, byte hit ratio and number of open origin connections are
+ * exported as traced values.
+ */
+class HttpProxy : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return type ID
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Constructor.
+   */
+  HttpProxy ();
+
+  /**
+   * \brief Destructor.
+   */
+  virtual ~HttpProxy ();
+
+  /**
+   * \brief Get the number of requests answered from the cache.
+   * \return the number of hits.
+   */
+  uint64_t GetHits (void) const;
+
+  /**
+   * \brief Get the number of cacheable requests forwarded to the server.
+   * \return the number of misses.
+   */
+  uint64_t GetMisses (void) const;
+
+  /**
+   * \brief Get the number of connections opened to the server so far.
+   * \return the number of connections.
+   */
+  uint32_t GetOriginConnectionsOpened (void) const;
+
+protected:
+  /**
+   * \brief Dispose this object;
+   */
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Start the application.
+   */
+  virtual void StartApplication (void);
+
+  /**
+   * \brief Stop the application.
+   */
+  virtual void StopApplication (void);
+
+  /**
+   * \brief Cached response.
+   */
+  struct CacheEntry
+  {
+    std::string url;                       //!< URL of the object.
+    uint32_t contentLength;                //!< Body size.
+    HttpHeader::ContentType contentType;   //!< Content type.
+    uint32_t numOfInlineObjects;           //!< Number of inline objects of a main object.
+  };
+
+  /**
+   * \brief State kept for each accepted client connection.
+   */
+  struct ClientConnection
+  {
+    Ptr<Socket> socket;        //!< Accepted socket.
+    Ipv4Address peer;          //!< Address of the client.
+    HttpStreamParser parser;   //!< Parser of the received requests.
+    HttpSendQueue sendQueue;   //!< Responses to send, in request order.
+  };
+
+  /**
+   * \brief Request forwarded to the server.
+   */
+  struct Fetch
+  {
+    Ptr<Socket> client;  //!< Socket of the client connection waiting for the response.
+    uint64_t response;   //!< Place of the response in the send queue of the client.
+    std::string url;     //!< URL requested.
+    bool cacheable;      //!< True if the response is stored in the cache.
+  };
+
+  /**
+   * \brief State kept for each connection to the server.
+   */
+  struct UpstreamConnection
+  {
+    UpstreamConnection () : connected (false) {}
+
+    Ptr<Socket> socket;          //!< Local socket.
+    bool connected;              //!< True once the server accepted the connection.
+    HttpStreamParser parser;     //!< Parser of the received responses.
+    std::deque<Fetch> fetches;   //!< Requests sent or waiting for the connection, in order.
+  };
+
+  bool HandleRequest (Ptr<Socket> s, const Address& address);
+  void HandleAccept (Ptr<Socket> s, const Address& address);
+
+  /**
+   * \brief Receive callback of the client connections.
+   * \param s socket of the connection.
+   */
+  void HandleClientReceive (Ptr<Socket> s);
+
+  /**
+   * \brief Send callback of the client connections.
+   * \param s socket of the connection.
+   * \param available number of bytes available in the send buffer.
+   */
+  void HandleClientSend (Ptr<Socket> s, uint32_t available);
+
+  /**
+   * \brief Release the state of a connection closed by the client.
+   * \param s socket of the connection.
+   */
+  void HandleClientClose (Ptr<Socket> s);
+
+  /**
+   * \brief Answer a request from the cache or forward it to the server.
+   * \param client the client connection.
+   * \param request the request header.
+   */
+  void ServeRequest (ClientConnection &client, const HttpHeader &request);
+
+  /**
+   * \brief Send a response to a client.
+   * \param client socket of the client connection.
+   * \param response place of the response in the send queue of the client.
+   * \param entry the response.
+   * \param statusCode status code of the response.
+   * \param phrase reason phrase of the response.
+   */
+  void Respond (Ptr<Socket> client, uint64_t response, const CacheEntry &entry,
+                const std::string &statusCode, const std::string &phrase);
+
+  /**
+   * \brief Look a URL up in the cache and mark it as most recently used.
+   * \param url the URL.
+   * \return the entry, or 0 on a miss.
+   */
+  const CacheEntry *Lookup (const std::string &url);
+
+  /**
+   * \brief Store a response in the cache, evicting the least recently used ones.
+   * \param entry the response.
+   */
+  void Insert (const CacheEntry &entry);
+
+  /**
+   * \brief Forward a request over the least loaded connection to the server,
+   * opening a new one if every connection is busy.
+   * \param fetch the request.
+   */
+  void Forward (const Fetch &fetch);
+
+  /**
+   * \brief Open a new connection to the server.
+   * \return the index of the connection.
+   */
+  uint32_t OpenUpstreamConnection (void);
+
+  /**
+   * \brief Send a request to the server.
+   * \param upstream the connection.
+   * \param url the URL.
+   */
+  void SendUpstreamRequest (UpstreamConnection &upstream, const std::string &url);
+
+  /**
+   * \brief Find the connection to the server that owns a socket.
+   * \param socket the socket.
+   * \return the connection, or 0.
+   */
+  UpstreamConnection *FindUpstream (Ptr<Socket> socket);
+
+  void UpstreamConnectionSucceeded (Ptr<Socket> socket);
+  void UpstreamConnectionFailed (Ptr<Socket> socket);
+
+  /**
+   * \brief Receive callback of the connections to the server.
+   * \param socket socket of the connection.
+   */
+  void HandleUpstreamReceive (Ptr<Socket> socket);
+
+  /**
+   * \brief Close callback of the connections to the server. Requests still
+   * waiting for a response are forwarded again.
+   * \param socket socket of the connection.
+   */
+  void HandleUpstreamClose (Ptr<Socket> socket);
+
+  /**
+   * \brief Update the hit ratio traced values.
+   * \param hit true for a hit.
+   * \param size body size of the object.
+   */
+  void RecordAccess (bool hit, uint32_t size);
+
+  Ptr<Socket> m_socket;                                  //!< Listening socket.
+  uint16_t m_port;                                       //!< Local port.
+  Address m_upstreamAddress;                             //!< Address of the server.
+  uint16_t m_upstreamPort;                               //!< Port of the server.
+  uint32_t m_maxUpstreamConnections;                     //!< Size limit of the pool of connections to the server.
+  uint64_t m_cacheSize;                                  //!< Capacity of the cache, in body bytes.
+
+  std::map<Ptr<Socket>, ClientConnection> m_clients;     //!< Accepted client connections.
+  std::vector<UpstreamConnection> m_upstreams;           //!< Connections to the server.
+
+  std::list<CacheEntry> m_lru;                           //!< Cached responses, most recently used first.
+  std::map<std::string, std::list<CacheEntry>::iterator> m_cacheIndex;  //!< Cached responses by URL.
+  uint64_t m_cacheBytes;                                 //!< Body bytes in the cache.
+
+  uint64_t m_hits;                                       //!< Number of hits.
+  uint64_t m_misses;                                     //!< Number of misses.
+  uint64_t m_hitBytes;                                   //!< Body bytes served from the cache.
+  uint64_t m_missBytes;                                  //!< Body bytes of the misses.
+  uint32_t m_originConnectionsOpened;                    //!< Connections opened to the server.
+  HttpHeader m_httpHeader;                               //!< Header of the forwarded requests.
+
+  TracedValue<double> m_hitRatio;                        //!< Fraction of cacheable requests served from the cache.
+  TracedValue<double> m_byteHitRatio;                    //!< Fraction of cacheable bytes served from the cache.
+  TracedValue<uint32_t> m_originConnections;             //!< Connections open to the server.
+};
+
+}
+
+#endif /* HTTP_PROXY_H_ */
@@ -0,0 +1,218 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "http-send-queue.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HttpSendQueue");
+
+HttpSendQueue::HttpSendQueue ()
+  : m_sndBufSize (0),
+    m_frameSize (0),
+    m_nextId (0),
+    m_next (0),
+    m_stalled (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HttpSendQueue::SetSocket (Ptr<Socket> socket, uint32_t sndBufSize)
+{
+  NS_LOG_FUNCTION (this << socket << sndBufSize);
+  m_socket = socket;
+  m_sndBufSize = sndBufSize;
+}
+
+void
+HttpSendQueue::SetFrameSize (uint32_t frameSize)
+{
+  NS_LOG_FUNCTION (this << frameSize);
+  NS_ASSERT_MSG (frameSize <= HttpFrameHeader::MAX_LENGTH, "HttpSendQueue >> Frame size too large.");
+  m_frameSize = frameSize;
+}
+
+void
+HttpSendQueue::Enqueue (const HttpHeader &header, uint32_t contentLength, uint32_t streamId)
+{
+  NS_LOG_FUNCTION (this << contentLength << streamId);
+  Fill (Reserve (streamId), header, contentLength);
+}
+
+uint64_t
+HttpSendQueue::Reserve (uint32_t streamId)
+{
+  NS_LOG_FUNCTION (this << streamId);
+  m_responses.push_back (PendingResponse ());
+  m_responses.back ().id = m_nextId;
+  m_responses.back ().streamId = streamId;
+  return m_nextId++;
+}
+
+void
+HttpSendQueue::Fill (uint64_t id, const HttpHeader &header, uint32_t contentLength)
+{
+  NS_LOG_FUNCTION (this << id << contentLength);
+
+  // Responses only leave the middle of the queue when framed, so the ids
+  // are still sorted.
+  PendingResponse key;
+  key.id = id;
+  std::deque<PendingResponse>::iterator it = std::lower_bound (m_responses.begin (), m_responses.end (), key);
+  NS_ASSERT_MSG (it != m_responses.end () && it->id == id, "HttpSendQueue >> Unknown response " << id);
+
+  PendingResponse &response = *it;
+  NS_ASSERT_MSG (!response.ready, "HttpSendQueue >> Response " << id << " filled twice.");
+  response.header = Create<Packet> ();
+  response.header->AddHeader (header);
+  if (m_frameSize > 0)
+    {
+      HttpFrameHeader frame;
+      frame.SetType (HttpFrameHeader::HEADERS);
+      frame.SetFlags (HttpFrameHeader::END_HEADERS | (contentLength == 0 ? HttpFrameHeader::END_STREAM : 0));
+      frame.SetLength (response.header->GetSize ());
+      frame.SetStreamId (response.streamId);
+      response.header->AddHeader (frame);
+    }
+  response.bytesPending = contentLength;
+  response.ready = true;
+}
+
+bool
+HttpSendQueue::NextReady (uint32_t &index)
+{
+  if (m_frameSize == 0)
+    {
+      // HTTP/1.1 responses go out strictly in order.
+      index = 0;
+      return !m_responses.empty () && m_responses.front ().ready;
+    }
+
+  for (uint32_t n = 0; n < m_responses.size (); n++)
+    {
+      index = (m_next + n) % m_responses.size ();
+      if (m_responses[index].ready)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+HttpSendQueue::Push (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t index;
+  while (NextReady (index))
+    {
+      PendingResponse &response = m_responses[index];
+      uint32_t txAvailable = m_socket->GetTxAvailable ();
+      int sent = -1;
+
+      if (response.header != 0)
+        {
+          // The header is sent in one piece, so it must fit in the buffer.
+          if (txAvailable >= response.header->GetSize ())
+            {
+              sent = m_socket->Send (response.header);
+              if (sent >= 0)
+                {
+                  response.header = 0;
+                }
+            }
+        }
+      else if (response.bytesPending == 0)
+        {
+          sent = 0;
+        }
+      else if (m_frameSize == 0)
+        {
+          if (txAvailable > 0)
+            {
+              // Body chunks are never larger than the TCP Sending Buffer.
+              uint32_t chunk = std::min (std::min (response.bytesPending, txAvailable), m_sndBufSize);
+              sent = m_socket->Send (Create<Packet> (chunk));
+              if (sent > 0)
+                {
+                  response.bytesPending -= sent;
+                }
+            }
+        }
+      else if (txAvailable > HttpFrameHeader::SIZE)
+        {
+          uint32_t chunk = std::min (std::min (response.bytesPending, txAvailable - HttpFrameHeader::SIZE), m_frameSize);
+          HttpFrameHeader frame;
+          frame.SetType (HttpFrameHeader::DATA);
+          frame.SetFlags (chunk == response.bytesPending ? HttpFrameHeader::END_STREAM : 0);
+          frame.SetLength (chunk);
+          frame.SetStreamId (response.streamId);
+          Ptr<Packet> packet = Create<Packet> (chunk);
+          packet->AddHeader (frame);
+          sent = m_socket->Send (packet);
+          if (sent > 0)
+            {
+              response.bytesPending -= chunk;
+            }
+        }
+
+      if (sent < 0)
+        {
+          // Waiting for the socket to call the send callback again when there is room.
+          bool newStall = !m_stalled;
+          m_stalled = true;
+          return newStall;
+        }
+
+      m_stalled = false;
+      if (response.header == 0 && response.bytesPending == 0)
+        {
+          m_responses.erase (m_responses.begin () + index);
+          m_next = index;
+        }
+      else
+        {
+          // One frame per response in turn.
+          m_next = index + 1;
+        }
+    }
+  return false;
+}
+
+uint32_t
+HttpSendQueue::GetBytesPending (void) const
+{
+  if (m_responses.empty ())
+    {
+      return 0;
+    }
+  return m_responses.front ().bytesPending;
+}
+
+bool
+HttpSendQueue::IsEmpty (void) const
+{
+  return m_responses.empty ();
+}
+
+}
@@ -0,0 +1,162 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#ifndef HTTP_SEND_QUEUE_H_
+#define HTTP_SEND_QUEUE_H_
+
+#include "ns3/socket.h"
+#include "ns3/packet.h"
+#include "ns3/http-header.h"
+#include "ns3/http-frame-header.h"
+#include <deque>
+
+namespace ns3 {
+
+/**
+ * \ingroup http
+ *
+ * Ordered queue of the HTTP responses of a connection, streamed to the
+ * socket as its send buffer frees up. Each response header is sent in one
+ * piece and its body in chunks no larger than the TCP send buffer.
+ *
+ * A response whose content is not known yet (for example, still being
+ * fetched from another server) can be reserved in request order and
+ * filled later. It holds back the responses queued after it.
+ *
+ * With a frame size set, the responses are sent as HEADERS and DATA frames
+ * of the multiplexed transport (see HttpFrameHeader) instead. The frames
+ * of the ready responses are then interleaved round robin, and a reserved
+ * response holds back nothing.
+ *
+ * Typical use:
+ * \code
+ *   queue.Enqueue (header, contentLength);
+ *   if (queue.Push ())
+ *     {
+ *       // the send buffer is full, Push again from the socket send callback
+ *     }
+ * \endcode
+ */
+class HttpSendQueue
+{
+public:
+  /**
+   * \brief Constructor.
+   */
+  HttpSendQueue ();
+
+  /**
+   * \brief Set the socket the responses are sent on.
+   * \param socket the socket.
+   * \param sndBufSize size of the TCP send buffer of the socket.
+   */
+  void SetSocket (Ptr<Socket> socket, uint32_t sndBufSize);
+
+  /**
+   * \brief Send the responses as frames of the multiplexed transport.
+   * \param frameSize largest DATA frame payload, 0 for a plain HTTP/1.1 byte stream.
+   */
+  void SetFrameSize (uint32_t frameSize);
+
+  /**
+   * \brief Queue a response.
+   * \param header response header.
+   * \param contentLength number of body bytes announced in the header.
+   * \param streamId stream of the response, when sent as frames.
+   */
+  void Enqueue (const HttpHeader &header, uint32_t contentLength, uint32_t streamId = 0);
+
+  /**
+   * \brief Reserve the place of a response that will be filled later.
+   * \param streamId stream of the response, when sent as frames.
+   * \return id of the response, to be passed to Fill.
+   */
+  uint64_t Reserve (uint32_t streamId = 0);
+
+  /**
+   * \brief Fill a reserved response.
+   * \param id id returned by Reserve.
+   * \param header response header.
+   * \param contentLength number of body bytes announced in the header.
+   */
+  void Fill (uint64_t id, const HttpHeader &header, uint32_t contentLength);
+
+  /**
+   * \brief Push as much of the ready responses as the TCP send buffer accepts.
+   * \return true if sending just stopped because the send buffer is full.
+   * A stall is reported once, until some bytes can be sent again.
+   */
+  bool Push (void);
+
+  /**
+   * \brief Get the body bytes of the first response not yet sent.
+   * \return the number of bytes.
+   */
+  uint32_t GetBytesPending (void) const;
+
+  /**
+   * \brief Check if every queued response has been handed to the socket.
+   * \return true if the queue is empty.
+   */
+  bool IsEmpty (void) const;
+
+private:
+  /**
+   * \brief Response waiting to be streamed.
+   */
+  struct PendingResponse
+  {
+    PendingResponse () : id (0), streamId (0), bytesPending (0), ready (false) {}
+
+    uint64_t id;            //!< Id returned by Reserve.
+    uint32_t streamId;      //!< Stream of the response, when sent as frames.
+    Ptr<Packet> header;     //!< Serialized response header not yet sent.
+    uint32_t bytesPending;  //!< Body bytes not yet handed to the socket.
+    bool ready;             //!< False while a reserved response is not filled.
+
+    /**
+     * \brief Order responses by id.
+     * \param other the other response.
+     * \return true if this response was reserved first.
+     */
+    bool operator< (const PendingResponse &other) const
+    {
+      return id < other.id;
+    }
+  };
+
+  /**
+   * \brief Find the next response to send a piece of.
+   * \param index set to the index of the response in m_responses.
+   * \return false if no response is ready.
+   */
+  bool NextReady (uint32_t &index);
+
+  Ptr<Socket> m_socket;                     //!< Socket of the connection.
+  uint32_t m_sndBufSize;                    //!< TCP send buffer size of the socket.
+  uint32_t m_frameSize;                     //!< Largest DATA frame payload, 0 if not framed.
+  std::deque<PendingResponse> m_responses;  //!< Responses to send, in request order.
+  uint64_t m_nextId;                        //!< Id of the next reserved response.
+  uint32_t m_next;                          //!< Index of the next response served round robin.
+  bool m_stalled;                           //!< True while waiting for send buffer space.
+};
+
+}
+
+#endif /* HTTP_SEND_QUEUE_H_ */
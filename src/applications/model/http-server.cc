@@ -21,10 +21,14 @@
 #include "ns3/simulator.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/abort.h"
+#include "ns3/string.h"
 #include "ns3/packet.h"
-#include "ns3/tcp-socket-base.h"
 #include "ns3/drop-tail-queue.h"
+#include "ns3/trace-source-accessor.h"
 #include "http-server.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -41,6 +45,81 @@ HttpServer::GetTypeId (void)
                    UintegerValue (80),
                    MakeUintegerAccessor (&HttpServer::m_port),
                    MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("Multiplexing",
+                   "Use the multiplexed, HTTP/2-style framed transport instead of HTTP/1.1. "
+                   "The clients must use it too.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&HttpServer::m_multiplexing),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxFrameSize",
+                   "Largest DATA frame payload, in bytes, when multiplexed.",
+                   UintegerValue (16384),
+                   MakeUintegerAccessor (&HttpServer::m_maxFrameSize),
+                   MakeUintegerChecker<uint32_t> (1, HttpFrameHeader::MAX_LENGTH))
+    //Scale, Shape, Mean, Mu and Sigma data was taken from paper "An HTTP Web Traffic Model
+    //Based on the Top One Million Visited Web Pages" by Rastin Pries et. al (Table II).
+    .AddAttribute ("MainObjectSize",
+                   "A RandomVariableStream used to pick the size of the main objects.",
+                   StringValue ("ns3::WeibullRandomVariable[Scale=19104.9|Shape=0.771807]"),
+                   MakePointerAccessor (&HttpServer::m_mainObjectSizeStream),
+                   MakePointerChecker <RandomVariableStream>())
+    .AddAttribute ("NumOfInlineObjects",
+                   "A RandomVariableStream used to pick the number of inline objects of a web page.",
+                   StringValue ("ns3::ExponentialRandomVariable[Mean=31.9291]"),
+                   MakePointerAccessor (&HttpServer::m_numOfInlineObjStream),
+                   MakePointerChecker <RandomVariableStream>())
+    .AddAttribute ("InlineObjectSize",
+                   "A RandomVariableStream used to pick the size of the inline objects.",
+                   StringValue ("ns3::LogNormalRandomVariable[Mu=8.91365|Sigma=1.24816]"),
+                   MakePointerAccessor (&HttpServer::m_inlineObjectSizeStream),
+                   MakePointerChecker <RandomVariableStream>())
+    .AddAttribute ("CatalogSize",
+                   "Number of pages of the site catalog built when the application starts, "
+                   "with object sizes drawn once from the RandomVariableStreams above. Page "
+                   "URLs are then always answered with the same objects. 0 disables the catalog.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&HttpServer::m_catalogSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("WorkloadTrace",
+                   "Workload trace the objects of pages are taken from, instead of the catalog. "
+                   "Requests for other URLs are served with the RandomVariableStreams above.",
+                   PointerValue (),
+                   MakePointerAccessor (&HttpServer::m_workloadTrace),
+                   MakePointerChecker<HttpWorkloadTrace> ())
+    .AddAttribute ("NumOfWorkers",
+                   "Number of workers serving the requests in parallel. 0 answers every "
+                   "request at once, without ServiceTime.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&HttpServer::m_numOfWorkers),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ServiceTime",
+                   "A RandomVariableStream used to pick the time (in seconds) a worker takes "
+                   "to serve a request.",
+                   StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"),
+                   MakePointerAccessor (&HttpServer::m_serviceTimeStream),
+                   MakePointerChecker <RandomVariableStream>())
+    .AddAttribute ("MaxQueueLength",
+                   "Maximum number of requests waiting for a worker. Requests arriving at a "
+                   "full queue are dropped. 0 for no limit.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&HttpServer::m_maxQueueLength),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("QueueLength",
+                     "Number of requests waiting for a worker.",
+                     MakeTraceSourceAccessor (&HttpServer::m_queueLength),
+                     "ns3::TracedValueCallback::Uint32")
+    .AddTraceSource ("QueueingDelay",
+                     "Time a request waited for a worker.",
+                     MakeTraceSourceAccessor (&HttpServer::m_queueingDelayTrace),
+                     "ns3::Time::TracedCallback")
+    .AddTraceSource ("Drop",
+                     "A request was dropped because the queue was full.",
+                     MakeTraceSourceAccessor (&HttpServer::m_dropTrace),
+                     "ns3::HttpServer::RequestTracedCallback")
+    .AddTraceSource ("TxStall",
+                     "The TCP send buffer was full while response bytes were pending.",
+                     MakeTraceSourceAccessor (&HttpServer::m_txStallTrace),
+                     "ns3::HttpServer::TxStallTracedCallback")
   ;
   return tid;
 }
@@ -50,6 +129,10 @@ HttpServer::HttpServer ()
   NS_LOG_FUNCTION (this);
 
   m_socket = 0;
+  m_txStalls = 0;
+  m_busyWorkers = 0;
+  m_drops = 0;
+  m_queueLength = 0;
 }
 
 HttpServer::~HttpServer ()
@@ -61,13 +144,54 @@ void
 HttpServer::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_connections.clear ();
+  m_mainObjectSizeStream = 0;
+  m_numOfInlineObjStream = 0;
+  m_inlineObjectSizeStream = 0;
+  m_workloadTrace = 0;
+  m_serviceTimeStream = 0;
+  m_workers.clear ();
+  m_queue.clear ();
+  m_catalogMainObjectSize.clear ();
+  m_catalogFirstInlineObject.clear ();
+  m_catalogInlineObjectSize.clear ();
   Application::DoDispose ();
 }
 
+int64_t
+HttpServer::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_mainObjectSizeStream->SetStream (stream);
+  m_numOfInlineObjStream->SetStream (stream + 1);
+  m_inlineObjectSizeStream->SetStream (stream + 2);
+  m_serviceTimeStream->SetStream (stream + 3);
+  return 4;
+}
+
+uint64_t
+HttpServer::GetTxStalls (void) const
+{
+  return m_txStalls;
+}
+
+uint64_t
+HttpServer::GetDrops (void) const
+{
+  return m_drops;
+}
+
 void HttpServer::StartApplication (void)
 {
   NS_LOG_FUNCTION (this);
 
+  if (m_catalogSize > 0 && m_catalogMainObjectSize.empty ())
+    {
+      BuildCatalog ();
+    }
+
+  m_workers.resize (m_numOfWorkers);
+
   if (!m_socket)
     {
       TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
@@ -92,6 +216,30 @@ void HttpServer::StartApplication (void)
     }
 }
 
+void
+HttpServer::BuildCatalog (void)
+{
+  NS_LOG_FUNCTION (this << m_catalogSize);
+
+  m_catalogMainObjectSize.resize (m_catalogSize);
+  m_catalogFirstInlineObject.resize (m_catalogSize + 1);
+  m_catalogInlineObjectSize.clear ();
+  for (uint32_t page = 0; page < m_catalogSize; page++)
+    {
+      m_catalogMainObjectSize[page] = m_mainObjectSizeStream->GetInteger ();
+      m_catalogFirstInlineObject[page] = m_catalogInlineObjectSize.size ();
+      uint32_t numOfInlineObj = m_numOfInlineObjStream->GetInteger ();
+      for (uint32_t i = 0; i < numOfInlineObj; i++)
+        {
+          m_catalogInlineObjectSize.push_back (m_inlineObjectSizeStream->GetInteger ());
+        }
+    }
+  m_catalogFirstInlineObject[m_catalogSize] = m_catalogInlineObjectSize.size ();
+
+  NS_LOG_INFO ("HttpServer >> Catalog of " << m_catalogSize << " pages and "
+               << m_catalogInlineObjectSize.size () << " inline objects built.");
+}
+
 void HttpServer::StopApplication (void)
 {
   NS_LOG_FUNCTION (this);
@@ -104,6 +252,21 @@ void HttpServer::StopApplication (void)
     {
       NS_LOG_WARN ("HttpServerApplication found null socket to close in StopApplication");
     }
+
+  for (uint32_t i = 0; i < m_workers.size (); i++)
+    {
+      Simulator::Cancel (m_workers[i].event);
+      m_workers[i] = Worker ();
+    }
+  m_busyWorkers = 0;
+  m_queue.clear ();
+  m_queueLength = 0;
+
+  NS_LOG_INFO ("HttpServer >> Sender stalled " << m_txStalls << " times waiting for TCP buffer space.");
+  if (m_numOfWorkers > 0)
+    {
+      NS_LOG_INFO ("HttpServer >> " << m_drops << " requests dropped.");
+    }
 }
 
 
@@ -121,8 +284,33 @@ HttpServer::HandleAccept (Ptr<Socket> s, const Address& address)
 {
   NS_LOG_FUNCTION (this << s << address);
 
-  NS_LOG_DEBUG ("HttpServer >> Connection with Client (" <<  InetSocketAddress::ConvertFrom (address).GetIpv4 () << ") successfully established!");
+  Connection &conn = m_connections[s];
+  conn.socket = s;
+  conn.peer = InetSocketAddress::ConvertFrom (address).GetIpv4 ();
+  conn.establishedTime = Simulator::Now ();
+
+  // Caching the TCP Sending Buffer Size of the accepted socket.
+  UintegerValue bufSizeValue;
+  s->GetAttribute ("SndBufSize", bufSizeValue);
+  conn.sendQueue.SetSocket (s, bufSizeValue.Get ());
+  if (m_multiplexing)
+    {
+      conn.sendQueue.SetFrameSize (m_maxFrameSize);
+    }
+
+  NS_LOG_DEBUG ("HttpServer >> Connection with Client (" << conn.peer << ") successfully established!");
   s->SetRecvCallback (MakeCallback (&HttpServer::HandleReceive, this));
+  s->SetSendCallback (MakeCallback (&HttpServer::HandleSend, this));
+  s->SetCloseCallbacks (MakeCallback (&HttpServer::HandleClose, this),
+                        MakeCallback (&HttpServer::HandleClose, this));
+}
+
+
+void
+HttpServer::HandleClose (Ptr<Socket> s)
+{
+  NS_LOG_FUNCTION (this << s);
+  m_connections.erase (s);
 }
 
 
@@ -131,95 +319,320 @@ HttpServer::HandleReceive (Ptr<Socket> s)
 {
   NS_LOG_FUNCTION (this << s);
 
-  HttpHeader httpHeaderIn;
-  Ptr<Packet> packet = s->Recv();
+  std::map<Ptr<Socket>, Connection>::iterator it = m_connections.find (s);
+  NS_ASSERT_MSG (it != m_connections.end (), "HttpServer >> Data received on an unknown connection.");
+  Connection &conn = it->second;
 
-  // Getting TCP Sending Buffer Size.
-  Ptr<TcpSocketBase> tcp = CreateObject<TcpSocketBase> ();
-  NS_ASSERT (tcp != 0);
-  UintegerValue bufSizeValue;
-  tcp->GetAttribute ("SndBufSize", bufSizeValue);
-  uint32_t tcpBufSize = bufSizeValue.Get();
+  Ptr<Packet> packet;
+  while ((packet = s->Recv ()))
+    {
+      if (packet->GetSize () == 0)
+        { //EOF
+          break;
+        }
+
+      if (m_multiplexing)
+        {
+          // Requests carry no body, so only their HEADERS frames matter.
+          while (conn.frameParser.Parse (packet))
+            {
+              const HttpFrameHeader &frame = conn.frameParser.GetFrameHeader ();
+              if (frame.GetType () != HttpFrameHeader::HEADERS)
+                {
+                  continue;
+                }
+              // The other streams go on, so a malformed request is answered
+              // on its own stream rather than left hanging.
+              if (!conn.frameParser.IsHeaderValid ())
+                {
+                  NS_LOG_WARN ("HttpServer >> Client (" << conn.peer << ") sent a malformed request on stream "
+                               << frame.GetStreamId () << ". Answered with 400.");
+                  HttpHeader httpHeaderOut;
+                  httpHeaderOut.SetRequest(false);
+                  httpHeaderOut.SetVersion("HTTP/1.1");
+                  httpHeaderOut.SetStatusCode("400");
+                  httpHeaderOut.SetPhrase("Bad Request");
+                  httpHeaderOut.SetContentLength(0);
+                  httpHeaderOut.SetContentType(HttpHeader::NO_CONTENT_TYPE);
+                  httpHeaderOut.SetNumOfInlineObjects(0);
+                  SendResponse (conn, httpHeaderOut, 0, frame.GetStreamId ());
+                  continue;
+                }
+              ServeRequest (conn, conn.frameParser.GetHeader (), frame.GetStreamId ());
+            }
+          continue;
+        }
+
+      // Pipelined requests may arrive together. They are answered in order.
+      while (conn.parser.Parse (packet))
+        {
+          ServeRequest (conn, conn.parser.GetHeader (), 0);
+        }
+    }
+}
 
-  packet->PeekHeader(httpHeaderIn);
 
-  string url = httpHeaderIn.GetUrl();
+void
+HttpServer::ServeRequest (Connection &conn, const HttpHeader &request, uint32_t streamId)
+{
+  NS_LOG_FUNCTION (this << conn.socket << streamId);
+
+  string url = request.GetUrl();
 
-  NS_LOG_INFO ("HttpServer >> Client requesting a " + url);
+  conn.requests++;
+  NS_LOG_INFO ("HttpServer >> Client (" << conn.peer << ") requesting a " << url);
 
-  if (url == "main/object")
+  if (m_numOfWorkers == 0)
     {
-      //Scale, Shape and Mean data was taken from paper "An HTTP Web Traffic Model Based on the
-      //Top One Million Visited Web Pages" by Rastin Pries et. al (Table II).
-      Ptr<WeibullRandomVariable> mainObjectSizeStream = CreateObject<WeibullRandomVariable> ();
-      mainObjectSizeStream->SetAttribute("Scale", DoubleValue (19104.9));
-      mainObjectSizeStream->SetAttribute("Shape", DoubleValue (0.771807));
-      uint32_t mainObjectSize = mainObjectSizeStream->GetInteger();
+      HttpHeader httpHeaderOut;
+      uint32_t objectSize = BuildResponse (url, httpHeaderOut);
+      SendResponse (conn, httpHeaderOut, objectSize, streamId);
+      return;
+    }
 
-      Ptr<ExponentialRandomVariable> numOfInlineObjStream = CreateObject<ExponentialRandomVariable> ();
-      numOfInlineObjStream->SetAttribute ("Mean", DoubleValue (31.9291));
-      uint32_t numOfInlineObj = numOfInlineObjStream->GetInteger();
+  // The place of the response is kept, so pipelined responses still leave in order.
+  Job job;
+  job.socket = conn.socket;
+  job.url = url;
+  job.response = conn.sendQueue.Reserve (streamId);
+  job.arrival = Simulator::Now ();
+
+  if (m_busyWorkers < m_numOfWorkers)
+    {
+      uint32_t worker = 0;
+      while (m_workers[worker].busy)
+        {
+          worker++;
+        }
+      StartService (worker, job);
+    }
+  else if (m_maxQueueLength == 0 || m_queue.size () < m_maxQueueLength)
+    {
+      m_queue.push_back (job);
+      m_queueLength = m_queue.size ();
+    }
+  else
+    {
+      m_drops++;
+      m_dropTrace (conn.socket, url);
+      NS_LOG_INFO ("HttpServer >> Queue full, dropping the request for " << url << ".");
+
+      uint64_t page;
+      uint32_t object;
+      bool mainObject;
+      if (!HttpWorkloadTrace::ParseUrl (url, page, object, mainObject))
+        {
+          mainObject = url == "main/object";
+        }
 
-      //Setting response
       HttpHeader httpHeaderOut;
       httpHeaderOut.SetRequest(false);
       httpHeaderOut.SetVersion("HTTP/1.1");
-      httpHeaderOut.SetStatusCode("200");
-      httpHeaderOut.SetPhrase("OK");
-      httpHeaderOut.SetHeaderField("ContentLength", mainObjectSize);
-      httpHeaderOut.SetHeaderField("ContentType", "main/object");
-      httpHeaderOut.SetHeaderField("NumOfInlineObjects", numOfInlineObj);
-
-      //Verifying if the buffer can store this packet size
-      if (mainObjectSize > tcpBufSize)
+      httpHeaderOut.SetStatusCode("503");
+      httpHeaderOut.SetPhrase("Service Unavailable");
+      httpHeaderOut.SetContentLength(0);
+      httpHeaderOut.SetContentType(mainObject ? HttpHeader::MAIN_OBJECT : HttpHeader::INLINE_OBJECT);
+      httpHeaderOut.SetNumOfInlineObjects(0);
+      conn.sendQueue.Fill (job.response, httpHeaderOut, 0);
+      PushPending (conn);
+    }
+}
+
+
+void
+HttpServer::StartService (uint32_t index, const Job &job)
+{
+  NS_LOG_FUNCTION (this << index << job.url);
+
+  Worker &worker = m_workers[index];
+  NS_ASSERT (!worker.busy);
+  worker.busy = true;
+  worker.job = job;
+  m_busyWorkers++;
+  m_queueingDelayTrace (Simulator::Now () - job.arrival);
+
+  Time serviceTime = Seconds (m_serviceTimeStream->GetValue ());
+  worker.event = Simulator::Schedule (serviceTime, &HttpServer::FinishService, this, index);
+}
+
+
+void
+HttpServer::FinishService (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+
+  Worker &worker = m_workers[index];
+  worker.busy = false;
+  m_busyWorkers--;
+
+  std::map<Ptr<Socket>, Connection>::iterator it = m_connections.find (worker.job.socket);
+  if (it != m_connections.end ())
+    {
+      HttpHeader httpHeaderOut;
+      uint32_t objectSize = BuildResponse (worker.job.url, httpHeaderOut);
+      it->second.sendQueue.Fill (worker.job.response, httpHeaderOut, objectSize);
+      PushPending (it->second);
+    }
+  else
+    {
+      NS_LOG_DEBUG ("HttpServer >> Client closed the connection before " << worker.job.url << " was served.");
+    }
+  worker.job = Job ();
+
+  if (!m_queue.empty ())
+    {
+      Job job = m_queue.front ();
+      m_queue.pop_front ();
+      m_queueLength = m_queue.size ();
+      StartService (index, job);
+    }
+}
+
+
+uint32_t
+HttpServer::BuildResponse (const std::string &url, HttpHeader &httpHeaderOut)
+{
+  NS_LOG_FUNCTION (this << url);
+
+  bool mainObject;
+  uint32_t objectSize;
+  uint32_t numOfInlineObj = 0;
+  uint64_t page;
+  uint32_t object;
+  if (HttpWorkloadTrace::ParseUrl (url, page, object, mainObject))
+    {
+      if (m_workloadTrace != 0)
+        {
+          // Replaying a page of the workload trace.
+          if (page >= m_workloadTrace->GetNumPages ()
+              || (!mainObject && object >= m_workloadTrace->GetNumOfInlineObjects (page)))
+            {
+              return BuildNotFound (url, mainObject, httpHeaderOut);
+            }
+          if (mainObject)
+            {
+              objectSize = m_workloadTrace->GetMainObjectSize (page);
+              numOfInlineObj = m_workloadTrace->GetNumOfInlineObjects (page);
+            }
+          else
+            {
+              objectSize = m_workloadTrace->GetInlineObjectSize (page, object);
+            }
+        }
+      else
         {
-          mainObjectSize = tcpBufSize - httpHeaderOut.GetSerializedSize();
-          httpHeaderOut.SetHeaderField("ContentLength", mainObjectSize);
+          if (page >= m_catalogMainObjectSize.size ())
+            {
+              return BuildNotFound (url, mainObject, httpHeaderOut);
+            }
+          uint32_t firstInline = m_catalogFirstInlineObject[page];
+          if (mainObject)
+            {
+              objectSize = m_catalogMainObjectSize[page];
+              numOfInlineObj = m_catalogFirstInlineObject[page + 1] - firstInline;
+            }
+          else
+            {
+              if (object >= m_catalogFirstInlineObject[page + 1] - firstInline)
+                {
+                  return BuildNotFound (url, mainObject, httpHeaderOut);
+                }
+              objectSize = m_catalogInlineObjectSize[firstInline + object];
+            }
         }
+    }
+  else
+    {
+      mainObject = url == "main/object";
+      if (mainObject)
+        {
+          objectSize = m_mainObjectSizeStream->GetInteger();
+          numOfInlineObj = m_numOfInlineObjStream->GetInteger();
+        }
+      else
+        {
+          objectSize = m_inlineObjectSizeStream->GetInteger();
+        }
+    }
 
-      Ptr<Packet> p = Create<Packet> (mainObjectSize);
-      p->AddHeader(httpHeaderOut);
+  //Setting response
+  httpHeaderOut.SetRequest(false);
+  httpHeaderOut.SetVersion("HTTP/1.1");
+  httpHeaderOut.SetStatusCode("200");
+  httpHeaderOut.SetPhrase("OK");
+  httpHeaderOut.SetContentLength(objectSize);
+  httpHeaderOut.SetContentType(mainObject ? HttpHeader::MAIN_OBJECT : HttpHeader::INLINE_OBJECT);
+  httpHeaderOut.SetNumOfInlineObjects(numOfInlineObj);
 
+  if (mainObject)
+    {
       NS_LOG_INFO ("HttpServer >> Sending response to client. Main Object Size ("
-                   << mainObjectSize << " bytes). NumOfInlineObjects ("
+                   << objectSize << " bytes). NumOfInlineObjects ("
                    << numOfInlineObj << ").");
-      s->Send(p);
     }
   else
     {
-      //Mu and Sigma data was taken from paper "An HTTP Web Traffic Model Based on the
-      //Top One Million Visited Web Pages" by Rastin Pries et. al (Table II).
-      Ptr<LogNormalRandomVariable> logNormal = CreateObject<LogNormalRandomVariable> ();
-      logNormal->SetAttribute("Mu", DoubleValue (8.91365));
-      logNormal->SetAttribute("Sigma", DoubleValue (1.24816));
+      NS_LOG_INFO ("HttpServer >> Sending response to client. Inline Objectsize ("
+                   << objectSize << " bytes).");
+    }
+  return objectSize;
+}
 
-      uint32_t inlineObjectSize = logNormal->GetInteger();
 
-      //Setting response
-      HttpHeader httpHeaderOut;
-      httpHeaderOut.SetRequest(false);
-      httpHeaderOut.SetVersion("HTTP/1.1");
-      httpHeaderOut.SetStatusCode("200");
-      httpHeaderOut.SetPhrase("OK");
-      httpHeaderOut.SetHeaderField("ContentLength", inlineObjectSize);
-      httpHeaderOut.SetHeaderField("ContentType", "inline/object");
-      httpHeaderOut.SetHeaderField("NumOfInlineObjects", 0);
-
-      //Verifying if the buffer can store this packet size
-      if (inlineObjectSize > tcpBufSize)
-        {
-          inlineObjectSize = tcpBufSize - httpHeaderOut.GetSerializedSize();
-          httpHeaderOut.SetHeaderField("ContentLength", inlineObjectSize);
-        }
+uint32_t
+HttpServer::BuildNotFound (const std::string &url, bool mainObject, HttpHeader &httpHeaderOut)
+{
+  NS_LOG_FUNCTION (this << url);
+
+  // A stray request, or a client with a larger catalog, must not stop the simulation.
+  NS_LOG_WARN ("HttpServer >> Request for " << url << ", which is not in the "
+               << (m_workloadTrace != 0 ? "workload trace." : "catalog."));
+  httpHeaderOut.SetRequest(false);
+  httpHeaderOut.SetVersion("HTTP/1.1");
+  httpHeaderOut.SetStatusCode("404");
+  httpHeaderOut.SetPhrase("Not Found");
+  httpHeaderOut.SetContentLength(0);
+  httpHeaderOut.SetContentType(mainObject ? HttpHeader::MAIN_OBJECT : HttpHeader::INLINE_OBJECT);
+  httpHeaderOut.SetNumOfInlineObjects(0);
+  return 0;
+}
 
-      Ptr<Packet> p = Create<Packet> (inlineObjectSize);
-      p->AddHeader(httpHeaderOut);
 
-      NS_LOG_INFO ("HttpServer >> Sending response to client. Inline Objectsize ("
-                   << inlineObjectSize << " bytes).");
-      s->Send(p);
+void
+HttpServer::SendResponse (Connection &conn, const HttpHeader &header, uint32_t contentLength, uint32_t streamId)
+{
+  NS_LOG_FUNCTION (this << conn.socket << contentLength << streamId);
+
+  conn.sendQueue.Enqueue (header, contentLength, streamId);
+  PushPending (conn);
+}
+
+
+void
+HttpServer::HandleSend (Ptr<Socket> s, uint32_t available)
+{
+  NS_LOG_FUNCTION (this << s << available);
+
+  std::map<Ptr<Socket>, Connection>::iterator it = m_connections.find (s);
+  if (it != m_connections.end ())
+    {
+      PushPending (it->second);
     }
 }
 
+
+void
+HttpServer::PushPending (Connection &conn)
+{
+  NS_LOG_FUNCTION (this << conn.socket);
+
+  if (conn.sendQueue.Push ())
+    {
+      m_txStalls++;
+      m_txStallTrace (conn.socket, conn.sendQueue.GetBytesPending ());
+      NS_LOG_DEBUG ("HttpServer >> Send buffer full, " << conn.sendQueue.GetBytesPending ()
+                    << " bytes pending to client (" << conn.peer << ").");
+    }
 }
 
+}
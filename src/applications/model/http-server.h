@@ -23,8 +23,21 @@
 #include "ns3/application.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/socket.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
+#include "ns3/event-id.h"
 #include "ns3/http-header.h"
+#include "ns3/http-stream-parser.h"
+#include "ns3/http-frame-parser.h"
+#include "ns3/http-send-queue.h"
+#include "ns3/http-workload-trace.h"
 #include "ns3/double.h"
+#include <map>
+#include <vector>
+#include <deque>
 
 using namespace std;
 
@@ -36,14 +49,28 @@ namespace ns3 {
  *
  * This is the server side of a HTTP Traffic Generator. The server
  * establishes a TCP connection with the client and waits for the
- * object requests. The implementation of this application is simplistic
- * and it does not support pipelining in this current version. The
- * model used is based on the distributions indicated in the paper
- * "An HTTP Web Traffic Model Based on the Top One Million Visited
- * Web Pages" by Rastin Pries et. al. This simplistic approach was
- * taken since this traffic generator was developed primarily to help
- * users evaluate their proposed algorithm in other modules of NS-3.
- * To allow deeper studies about the HTTP Protocol it needs some improvements.
+ * object requests. Pipelined requests are answered in the order they
+ * arrive. With the CatalogSize attribute the server builds a fixed site
+ * catalog when it starts, so every request for a page gets the same
+ * objects. Requests for the pages of a workload trace (see
+ * HttpWorkloadTrace) are answered with the object sizes of the trace. With
+ * the Multiplexing attribute the server speaks a framed, HTTP/2-style
+ * transport instead (see HttpFrameHeader): requests arrive as HEADERS
+ * frames on their own streams, and the responses of all streams of a
+ * connection are interleaved as frames of at most MaxFrameSize bytes.
+ * With the NumOfWorkers attribute each request takes a ServiceTime on one
+ * of a fixed number of workers, waiting in a FIFO queue of at most
+ * MaxQueueLength requests while all workers are busy, so the server can
+ * saturate. Requests arriving at a full queue are dropped and answered
+ * with an empty "503 Service Unavailable" response.
+ *
+ * The implementation of this application is simplistic. The model used
+ * is based on the distributions indicated in the paper "An HTTP Web
+ * Traffic Model Based on the Top One Million Visited Web Pages" by Rastin
+ * Pries et. al. This simplistic approach was taken since this traffic
+ * generator was developed primarily to help users evaluate their proposed
+ * algorithm in other modules of NS-3. To allow deeper studies about the
+ * HTTP Protocol it needs some improvements.
  */
 class HttpServer : public Application
 {
@@ -64,6 +91,43 @@ public:
    */
   virtual ~HttpServer ();
 
+  /**
+   * \brief Assign a fixed random variable stream number to the random variables
+   * used by this model.
+   * \param stream first stream index to use.
+   * \return the number of stream indices assigned by this model.
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * \brief Get the number of times the sender had to wait for space in
+   * the TCP send buffer before it could push more response bytes.
+   * \return number of transmission stalls.
+   */
+  uint64_t GetTxStalls (void) const;
+
+  /**
+   * \brief Get the number of requests dropped because the queue was full.
+   * \return number of drops.
+   */
+  uint64_t GetDrops (void) const;
+
+  /**
+   * TracedCallback signature for transmission stalls.
+   *
+   * \param [in] socket the socket whose send buffer is full.
+   * \param [in] bytesPending response bytes still waiting to be sent.
+   */
+  typedef void (* TxStallTracedCallback)(Ptr<const Socket> socket, uint32_t bytesPending);
+
+  /**
+   * TracedCallback signature for requests.
+   *
+   * \param [in] socket the socket the request arrived on.
+   * \param [in] url URL of the object requested.
+   */
+  typedef void (* RequestTracedCallback)(Ptr<const Socket> socket, const std::string &url);
+
 protected:
   /**
    * \brief Dispose this object;
@@ -81,6 +145,11 @@ private:
    */
   virtual void StopApplication (void);            // Called at time specified by Stop
 
+  /**
+   * \brief Draw the pages of the site catalog.
+   */
+  void BuildCatalog (void);
+
   /**
    * \brief Processes the request of client to establish a TCP connection.
    * \param socket socket that receives the TCP request for connection.
@@ -100,6 +169,181 @@ private:
    */
   void HandleReceive (Ptr<Socket> s);
 
+  /**
+   * \brief State kept for each accepted connection.
+   */
+  struct Connection
+  {
+    Connection () : requests (0) {}
+
+    Ptr<Socket> socket;         //!< Accepted socket.
+    Ipv4Address peer;           //!< Address of the client.
+    Time establishedTime;       //!< Time the connection was accepted.
+    uint32_t requests;          //!< Number of requests received on this connection.
+    HttpStreamParser parser;    //!< Parser of the received requests.
+    HttpFrameParser frameParser;  //!< Parser of the received frames, when multiplexed.
+    HttpSendQueue sendQueue;    //!< Responses to send, in request order.
+  };
+
+  /**
+   * \brief Request waiting for, or being served by, a worker.
+   */
+  struct Job
+  {
+    Job () : response (0) {}
+
+    Ptr<Socket> socket;  //!< Socket of the connection the request arrived on.
+    std::string url;     //!< URL of the object requested.
+    uint64_t response;   //!< Place of the response in the send queue of the connection.
+    Time arrival;        //!< Time the request arrived.
+  };
+
+  /**
+   * \brief Worker slot.
+   */
+  struct Worker
+  {
+    Worker () : busy (false) {}
+
+    bool busy;      //!< True while serving a request.
+    Job job;        //!< Request served.
+    EventId event;  //!< End of the service.
+  };
+
+  /**
+   * \brief Answer a request at once, or hand it to the worker pool.
+   * \param conn the connection the request arrived on.
+   * \param request the request header.
+   * \param streamId stream the request arrived on, when multiplexed.
+   */
+  void ServeRequest (Connection &conn, const HttpHeader &request, uint32_t streamId);
+
+  /**
+   * \brief Build the response to a request.
+   * \param url URL of the object requested.
+   * \param httpHeaderOut set to the response header.
+   * \return the number of body bytes of the response.
+   */
+  uint32_t BuildResponse (const std::string &url, HttpHeader &httpHeaderOut);
+
+  /**
+   * \brief Build the empty "404 Not Found" response to a request for a
+   * page or object the server does not have.
+   * \param url URL of the object requested.
+   * \param mainObject true if a main object was requested.
+   * \param httpHeaderOut set to the response header.
+   * \return the number of body bytes of the response, 0.
+   */
+  uint32_t BuildNotFound (const std::string &url, bool mainObject, HttpHeader &httpHeaderOut);
+
+  /**
+   * \brief Start serving a request on a worker.
+   * \param index index of the idle worker.
+   * \param job the request.
+   */
+  void StartService (uint32_t index, const Job &job);
+
+  /**
+   * \brief Send the response of a served request and take the next queued one.
+   * \param index index of the worker.
+   */
+  void FinishService (uint32_t index);
+
+  /**
+   * \brief Queue a response on the connection and start streaming it.
+   * Responses are sent in the order they were queued, or interleaved when
+   * multiplexed.
+   * \param conn the connection.
+   * \param header response header.
+   * \param contentLength number of body bytes announced in the header.
+   * \param streamId stream of the response, when multiplexed.
+   */
+  void SendResponse (Connection &conn, const HttpHeader &header, uint32_t contentLength, uint32_t streamId);
+
+  /**
+   * \brief Push as much of the pending response as the TCP send buffer accepts.
+   * \param conn the connection.
+   */
+  void PushPending (Connection &conn);
+
+  /**
+   * \brief Send callback of the accepted sockets.
+   * \param s socket of the connection.
+   * \param available number of bytes available in the send buffer.
+   */
+  void HandleSend (Ptr<Socket> s, uint32_t available);
+
+  /**
+   * \brief Release the state of a connection closed by the client.
+   * \param s socket of the connection.
+   */
+  void HandleClose (Ptr<Socket> s);
+
+  /**
+   * \brief Accepted connections.
+   */
+  std::map<Ptr<Socket>, Connection> m_connections;
+
+  /**
+   * \brief Number of transmission stalls.
+   */
+  uint64_t m_txStalls;
+
+  /**
+   * \brief Trace of transmission stalls.
+   */
+  TracedCallback<Ptr<const Socket>, uint32_t> m_txStallTrace;
+
+  /**
+   * \brief Number of workers, 0 to answer every request at once.
+   */
+  uint32_t m_numOfWorkers;
+
+  /**
+   * \brief Maximum number of queued requests, 0 for no limit.
+   */
+  uint32_t m_maxQueueLength;
+
+  /**
+   * \brief Random Variable Stream for the service time (in seconds) of the requests.
+   */
+  Ptr<RandomVariableStream> m_serviceTimeStream;
+
+  /**
+   * \brief Worker slots.
+   */
+  std::vector<Worker> m_workers;
+
+  /**
+   * \brief Number of busy workers.
+   */
+  uint32_t m_busyWorkers;
+
+  /**
+   * \brief Requests waiting for a worker, in arrival order.
+   */
+  std::deque<Job> m_queue;
+
+  /**
+   * \brief Number of dropped requests.
+   */
+  uint64_t m_drops;
+
+  /**
+   * \brief Number of requests waiting for a worker.
+   */
+  TracedValue<uint32_t> m_queueLength;
+
+  /**
+   * \brief Trace of the time the requests waited for a worker.
+   */
+  TracedCallback<Time> m_queueingDelayTrace;
+
+  /**
+   * \brief Trace of the dropped requests.
+   */
+  TracedCallback<Ptr<const Socket>, const std::string &> m_dropTrace;
+
   /**
    * \brief Local socket.
    */
@@ -109,6 +353,57 @@ private:
    * \brief Local port.
    */
   uint16_t m_port;
+
+  /**
+   * \brief True to use the multiplexed, framed transport.
+   */
+  bool m_multiplexing;
+
+  /**
+   * \brief Largest DATA frame payload, when multiplexed.
+   */
+  uint32_t m_maxFrameSize;
+
+  /**
+   * \brief Random Variable Stream for the size of main objects.
+   */
+  Ptr<RandomVariableStream> m_mainObjectSizeStream;
+
+  /**
+   * \brief Random Variable Stream for the number of inline objects.
+   */
+  Ptr<RandomVariableStream> m_numOfInlineObjStream;
+
+  /**
+   * \brief Random Variable Stream for the size of inline objects.
+   */
+  Ptr<RandomVariableStream> m_inlineObjectSizeStream;
+
+  /**
+   * \brief Workload trace replayed, if any.
+   */
+  Ptr<HttpWorkloadTrace> m_workloadTrace;
+
+  /**
+   * \brief Number of pages of the site catalog.
+   */
+  uint32_t m_catalogSize;
+
+  /**
+   * \brief Main object size of each catalog page.
+   */
+  std::vector<uint32_t> m_catalogMainObjectSize;
+
+  /**
+   * \brief Index in m_catalogInlineObjectSize of the first inline object of
+   * each catalog page, plus the total number of inline objects at the end.
+   */
+  std::vector<uint32_t> m_catalogFirstInlineObject;
+
+  /**
+   * \brief Inline object sizes of all catalog pages, page after page.
+   */
+  std::vector<uint32_t> m_catalogInlineObjectSize;
 };
 
 
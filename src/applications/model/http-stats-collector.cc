@@ -0,0 +1,235 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/node.h"
+#include "ns3/http-client.h"
+#include "http-stats-collector.h"
+#include <fstream>
+#include <iomanip>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HttpStatsCollector");
+
+NS_OBJECT_ENSURE_REGISTERED (HttpStatsCollector);
+
+TypeId
+HttpStatsCollector::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HttpStatsCollector")
+    .SetParent<Object> ()
+    .AddConstructor<HttpStatsCollector> ()
+    .AddAttribute ("OutputFile",
+                   "Name of the file the global statistics are written to when the simulation is destroyed. "
+                   "An empty name disables the output.",
+                   StringValue ("http-stats.txt"),
+                   MakeStringAccessor (&HttpStatsCollector::m_outputFile),
+                   MakeStringChecker ())
+    .AddAttribute ("Precision",
+                   "Number of significant bits kept for each delay. The relative error of the "
+                   "percentiles is below 2^-Precision.",
+                   UintegerValue (7),
+                   MakeUintegerAccessor (&HttpStatsCollector::m_precision),
+                   MakeUintegerChecker<uint32_t> (1, 16))
+  ;
+  return tid;
+}
+
+HttpStatsCollector::NodeStats::NodeStats (uint32_t precision)
+  : pagesLoaded (0)
+{
+  for (uint32_t i = 0; i < NUM_METRICS; i++)
+    {
+      histograms[i] = HttpLatencyHistogram (precision);
+    }
+}
+
+HttpStatsCollector::HttpStatsCollector ()
+  : m_writeScheduled (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HttpStatsCollector::~HttpStatsCollector ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HttpStatsCollector::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nodes.clear ();
+  Object::DoDispose ();
+}
+
+void
+HttpStatsCollector::Install (ApplicationContainer apps)
+{
+  NS_LOG_FUNCTION (this);
+
+  for (ApplicationContainer::Iterator it = apps.Begin (); it != apps.End (); ++it)
+    {
+      Ptr<HttpClient> client = DynamicCast<HttpClient> (*it);
+      if (client == 0)
+        {
+          continue;
+        }
+
+      uint32_t nodeId = client->GetNode ()->GetId ();
+      std::map<uint32_t, NodeStats>::iterator node = m_nodes.find (nodeId);
+      if (node == m_nodes.end ())
+        {
+          node = m_nodes.insert (std::make_pair (nodeId, NodeStats (m_precision))).first;
+        }
+      NodeStats *stats = &node->second;
+
+      client->TraceConnectWithoutContext ("PageLoaded",
+                                          MakeBoundCallback (&HttpStatsCollector::PageLoaded, stats));
+      client->TraceConnectWithoutContext ("TimeToFirstByte",
+                                          MakeBoundCallback (&HttpStatsCollector::FirstByteReceived, stats));
+      client->TraceConnectWithoutContext ("ObjectDownloaded",
+                                          MakeBoundCallback (&HttpStatsCollector::ObjectDownloaded, stats));
+    }
+
+  if (!m_writeScheduled)
+    {
+      m_writeScheduled = true;
+      Simulator::ScheduleDestroy (&HttpStatsCollector::WriteResults, Ptr<HttpStatsCollector> (this));
+    }
+}
+
+void
+HttpStatsCollector::PageLoaded (NodeStats *stats, uint32_t pageId, uint32_t numOfInlineObjects,
+                                Time delay, uint32_t size)
+{
+  stats->histograms[PAGE_LOAD_TIME].Record (delay);
+  stats->pagesLoaded++;
+}
+
+void
+HttpStatsCollector::FirstByteReceived (NodeStats *stats, uint32_t pageId, uint32_t numOfInlineObjects,
+                                       Time delay)
+{
+  stats->histograms[TIME_TO_FIRST_BYTE].Record (delay);
+}
+
+void
+HttpStatsCollector::ObjectDownloaded (NodeStats *stats, uint32_t pageId, uint32_t numOfInlineObjects,
+                                      Time delay, uint32_t size)
+{
+  stats->histograms[OBJECT_DOWNLOAD_TIME].Record (delay);
+}
+
+HttpLatencyHistogram
+HttpStatsCollector::GetHistogram (Metric metric) const
+{
+  NS_LOG_FUNCTION (this << metric);
+  NS_ASSERT (metric < NUM_METRICS);
+
+  HttpLatencyHistogram global (m_precision);
+  for (std::map<uint32_t, NodeStats>::const_iterator it = m_nodes.begin (); it != m_nodes.end (); ++it)
+    {
+      global.Merge (it->second.histograms[metric]);
+    }
+  return global;
+}
+
+HttpLatencyHistogram
+HttpStatsCollector::GetHistogram (Metric metric, uint32_t nodeId) const
+{
+  NS_LOG_FUNCTION (this << metric << nodeId);
+  NS_ASSERT (metric < NUM_METRICS);
+
+  std::map<uint32_t, NodeStats>::const_iterator it = m_nodes.find (nodeId);
+  if (it == m_nodes.end ())
+    {
+      return HttpLatencyHistogram (m_precision);
+    }
+  return it->second.histograms[metric];
+}
+
+uint64_t
+HttpStatsCollector::GetPagesLoaded (void) const
+{
+  uint64_t pages = 0;
+  for (std::map<uint32_t, NodeStats>::const_iterator it = m_nodes.begin (); it != m_nodes.end (); ++it)
+    {
+      pages += it->second.pagesLoaded;
+    }
+  return pages;
+}
+
+const char *
+HttpStatsCollector::MetricToString (Metric metric)
+{
+  switch (metric)
+    {
+    case PAGE_LOAD_TIME:
+      return "PageLoadTime";
+    case TIME_TO_FIRST_BYTE:
+      return "TimeToFirstByte";
+    case OBJECT_DOWNLOAD_TIME:
+      return "ObjectDownloadTime";
+    default:
+      return "Unknown";
+    }
+}
+
+void
+HttpStatsCollector::WriteResults (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_outputFile.empty ())
+    {
+      return;
+    }
+
+  std::ofstream out (m_outputFile.c_str ());
+  if (!out.is_open ())
+    {
+      NS_LOG_ERROR ("HttpStatsCollector >> Can't open file " << m_outputFile);
+      return;
+    }
+
+  out << "# nodes " << m_nodes.size () << " pages " << GetPagesLoaded () << std::endl;
+  out << "# metric samples mean(s) min(s) p50(s) p95(s) p99(s) p99.9(s) max(s)" << std::endl;
+  out << std::fixed << std::setprecision (6);
+  for (uint32_t i = 0; i < NUM_METRICS; i++)
+    {
+      Metric metric = static_cast<Metric> (i);
+      HttpLatencyHistogram global = GetHistogram (metric);
+      out << MetricToString (metric) << " " << global.GetCount ()
+          << " " << global.GetMean ().GetSeconds ()
+          << " " << global.GetMin ().GetSeconds ()
+          << " " << global.GetPercentile (50).GetSeconds ()
+          << " " << global.GetPercentile (95).GetSeconds ()
+          << " " << global.GetPercentile (99).GetSeconds ()
+          << " " << global.GetPercentile (99.9).GetSeconds ()
+          << " " << global.GetMax ().GetSeconds () << std::endl;
+    }
+  NS_LOG_INFO ("HttpStatsCollector >> Statistics written to " << m_outputFile);
+}
+
+}
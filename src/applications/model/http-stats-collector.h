@@ -0,0 +1,198 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#ifndef HTTP_STATS_COLLECTOR_H_
+#define HTTP_STATS_COLLECTOR_H_
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/application-container.h"
+#include "ns3/http-latency-histogram.h"
+#include <map>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup http
+ *
+ * Aggregates the performance traces of many HttpClient applications in
+ * fixed memory. The page load time, time to first byte and object download
+ * time of each node are recorded in HttpLatencyHistogram instances, so no
+ * sample is kept. When the simulation is destroyed, the histograms of all
+ * nodes are merged and the global percentiles are written to OutputFile.
+ *
+ * Typical use:
+ * \code
+ *   Ptr<HttpStatsCollector> stats = CreateObject<HttpStatsCollector> ();
+ *   stats->SetAttribute ("OutputFile", StringValue ("http-stats.txt"));
+ *   stats->Install (httpClientApps);
+ *   Simulator::Run ();
+ *   Simulator::Destroy ();  // http-stats.txt is written here
+ * \endcode
+ */
+class HttpStatsCollector : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return type ID
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Constructor.
+   */
+  HttpStatsCollector ();
+
+  /**
+   * \brief Destructor.
+   */
+  virtual ~HttpStatsCollector ();
+
+  /**
+   * \brief Measured metrics.
+   */
+  enum Metric
+  {
+    PAGE_LOAD_TIME,        //!< From the main object request to the last object of the page.
+    TIME_TO_FIRST_BYTE,    //!< From the main object request to its first byte.
+    OBJECT_DOWNLOAD_TIME,  //!< From the request of an object to its last byte.
+    NUM_METRICS            //!< Number of metrics.
+  };
+
+  /**
+   * \brief Connect to the trace sources of every HttpClient in a container.
+   * Other applications are ignored.
+   * \param apps the applications.
+   */
+  void Install (ApplicationContainer apps);
+
+  /**
+   * \brief Get the histogram of a metric merged over all nodes.
+   * \param metric the metric.
+   * \return the global histogram.
+   */
+  HttpLatencyHistogram GetHistogram (Metric metric) const;
+
+  /**
+   * \brief Get the histogram of a metric for a single node.
+   * \param metric the metric.
+   * \param nodeId id of the node.
+   * \return the histogram of the node, empty if the node has no client.
+   */
+  HttpLatencyHistogram GetHistogram (Metric metric, uint32_t nodeId) const;
+
+  /**
+   * \brief Get the number of web pages loaded by all clients.
+   * \return the number of pages.
+   */
+  uint64_t GetPagesLoaded (void) const;
+
+  /**
+   * \brief Write the global statistics to OutputFile.
+   */
+  void WriteResults (void) const;
+
+  /**
+   * \brief Get the name of a metric.
+   * \param metric the metric.
+   * \return the name.
+   */
+  static const char *MetricToString (Metric metric);
+
+protected:
+  /**
+   * \brief Dispose this object;
+   */
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Histograms of the clients of one node.
+   */
+  struct NodeStats
+  {
+    /**
+     * \brief Constructor.
+     * \param precision precision of the histograms.
+     */
+    NodeStats (uint32_t precision);
+
+    HttpLatencyHistogram histograms[NUM_METRICS];  //!< One histogram per metric.
+    uint64_t pagesLoaded;                          //!< Number of pages loaded.
+  };
+
+  /**
+   * \brief PageLoaded trace sink.
+   * \param stats statistics of the node of the client.
+   * \param pageId sequence number of the web page.
+   * \param numOfInlineObjects number of inline objects of the page.
+   * \param delay page load time.
+   * \param size page size.
+   */
+  static void PageLoaded (NodeStats *stats, uint32_t pageId, uint32_t numOfInlineObjects,
+                          Time delay, uint32_t size);
+
+  /**
+   * \brief TimeToFirstByte trace sink.
+   * \param stats statistics of the node of the client.
+   * \param pageId sequence number of the web page.
+   * \param numOfInlineObjects number of inline objects of the page.
+   * \param delay time to first byte.
+   */
+  static void FirstByteReceived (NodeStats *stats, uint32_t pageId, uint32_t numOfInlineObjects,
+                                 Time delay);
+
+  /**
+   * \brief ObjectDownloaded trace sink.
+   * \param stats statistics of the node of the client.
+   * \param pageId sequence number of the web page.
+   * \param numOfInlineObjects number of inline objects of the page.
+   * \param delay object download time.
+   * \param size object size.
+   */
+  static void ObjectDownloaded (NodeStats *stats, uint32_t pageId, uint32_t numOfInlineObjects,
+                                Time delay, uint32_t size);
+
+  /**
+   * \brief Statistics of each node, by node id. Map nodes are never moved,
+   * so the trace sinks keep a pointer to them.
+   */
+  std::map<uint32_t, NodeStats> m_nodes;
+
+  /**
+   * \brief Precision of the histograms.
+   */
+  uint32_t m_precision;
+
+  /**
+   * \brief Name of the output file.
+   */
+  std::string m_outputFile;
+
+  /**
+   * \brief True once WriteResults has been scheduled.
+   */
+  bool m_writeScheduled;
+};
+
+}
+
+#endif /* HTTP_STATS_COLLECTOR_H_ */
@@ -0,0 +1,167 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "http-stream-parser.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HttpStreamParser");
+
+HttpStreamParser::HttpStreamParser ()
+  : m_state (HEADER),
+    m_contentLength (0),
+    m_bodyReceived (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HttpStreamParser::Reset (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_state = HEADER;
+  m_headerBuf.clear ();
+  m_header = HttpHeader ();
+  m_contentLength = 0;
+  m_bodyReceived = 0;
+}
+
+const HttpHeader &
+HttpStreamParser::GetHeader (void) const
+{
+  return m_header;
+}
+
+bool
+HttpStreamParser::IsHeaderComplete (void) const
+{
+  return m_state != HEADER;
+}
+
+uint32_t
+HttpStreamParser::GetContentLength (void) const
+{
+  return m_contentLength;
+}
+
+uint32_t
+HttpStreamParser::GetBodyReceived (void) const
+{
+  return m_bodyReceived;
+}
+
+bool
+HttpStreamParser::Parse (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet->GetSize ());
+
+  if (m_state == COMPLETE)
+    {
+      Reset ();
+    }
+
+  if (m_state == HEADER)
+    {
+      if (packet->GetSize () == 0)
+        {
+          return false;
+        }
+      ParseHeader (packet);
+      if (m_state == HEADER)
+        {
+          return false;
+        }
+    }
+
+  uint32_t bodyBytes = std::min (packet->GetSize (), m_contentLength - m_bodyReceived);
+  packet->RemoveAtStart (bodyBytes);
+  m_bodyReceived += bodyBytes;
+
+  if (m_bodyReceived == m_contentLength)
+    {
+      m_state = COMPLETE;
+      return true;
+    }
+  return false;
+}
+
+void
+HttpStreamParser::ParseHeader (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this);
+
+  HttpHeader::ParseStatus status;
+  uint32_t offset = m_headerBuf.size ();
+
+  if (offset == 0)
+    {
+      // Common case: the whole header is in the packet and is parsed in place.
+      uint32_t used = packet->PeekHeader (m_header);
+      status = m_header.GetParseStatus ();
+      if (status == HttpHeader::PARSE_OK)
+        {
+          packet->RemoveAtStart (used);
+        }
+      else if (status == HttpHeader::PARSE_INCOMPLETE)
+        {
+          // The rest of the header is in the next segments.
+          m_headerBuf.resize (packet->GetSize ());
+          packet->CopyData (&m_headerBuf[0], m_headerBuf.size ());
+          packet->RemoveAtStart (packet->GetSize ());
+          return;
+        }
+    }
+  else
+    {
+      // Reassembling a header split over several segments.
+      uint32_t size = std::min (packet->GetSize (), HttpHeader::MAX_HEADER_SIZE + 1 - offset);
+      m_headerBuf.resize (offset + size);
+      packet->CopyData (&m_headerBuf[offset], size);
+
+      uint32_t used = m_header.Parse (&m_headerBuf[0], m_headerBuf.size ());
+      status = m_header.GetParseStatus ();
+      if (status == HttpHeader::PARSE_OK)
+        {
+          packet->RemoveAtStart (used - offset);
+          m_headerBuf.clear ();
+        }
+      else if (status == HttpHeader::PARSE_INCOMPLETE)
+        {
+          packet->RemoveAtStart (size);
+          return;
+        }
+    }
+
+  if (status != HttpHeader::PARSE_OK)
+    {
+      NS_LOG_ERROR ("HttpStreamParser >> Malformed header (status " << status
+                    << "). Dropping the received bytes.");
+      packet->RemoveAtStart (packet->GetSize ());
+      m_headerBuf.clear ();
+      return;
+    }
+
+  m_contentLength = m_header.GetRequest () ? 0 : m_header.GetContentLength ();
+  m_bodyReceived = 0;
+  m_state = BODY;
+}
+
+}
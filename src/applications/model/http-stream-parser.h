@@ -0,0 +1,125 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#ifndef HTTP_STREAM_PARSER_H_
+#define HTTP_STREAM_PARSER_H_
+
+#include "ns3/packet.h"
+#include "ns3/http-header.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup http
+ *
+ * Incremental parser of the HTTP messages carried by a TCP byte stream.
+ * Header bytes are kept in a reassembly buffer until the end of the header
+ * has arrived, so a header may be split over any number of segments (up
+ * to HttpHeader::MAX_HEADER_SIZE bytes). Body
+ * bytes are only counted. A single read may hold any number of messages.
+ *
+ * Typical use:
+ * \code
+ *   while (parser.Parse (packet))
+ *     {
+ *       const HttpHeader &header = parser.GetHeader ();
+ *       // the message is complete
+ *     }
+ * \endcode
+ */
+class HttpStreamParser
+{
+public:
+  /**
+   * \brief Constructor.
+   */
+  HttpStreamParser ();
+
+  /**
+   * \brief Consume bytes from the front of a packet.
+   *
+   * Bytes are removed from the packet until either the current message is
+   * complete or the packet is empty.
+   *
+   * \param packet received bytes.
+   * \return true if a message was completed. The packet may then still hold
+   * bytes of the following messages.
+   */
+  bool Parse (Ptr<Packet> packet);
+
+  /**
+   * \brief Get the header of the current message.
+   * \return the header, valid once IsHeaderComplete returns true.
+   */
+  const HttpHeader &GetHeader (void) const;
+
+  /**
+   * \brief Check if the header of the current message has arrived.
+   * \return true if the header is complete.
+   */
+  bool IsHeaderComplete (void) const;
+
+  /**
+   * \brief Get the body length announced by the header of the current message.
+   * \return the body length in bytes.
+   */
+  uint32_t GetContentLength (void) const;
+
+  /**
+   * \brief Get the number of body bytes of the current message received so far.
+   * \return the number of body bytes.
+   */
+  uint32_t GetBodyReceived (void) const;
+
+  /**
+   * \brief Drop any partially received message.
+   */
+  void Reset (void);
+
+private:
+  /**
+   * \brief Consume header bytes until a complete header has been parsed.
+   *
+   * The header is parsed in place when the packet holds all of it, and is
+   * copied to the reassembly buffer only when it is split over segments.
+   * \param packet received bytes.
+   */
+  void ParseHeader (Ptr<Packet> packet);
+
+  /**
+   * \brief Parser states.
+   */
+  enum State
+  {
+    HEADER,   //!< Waiting for the end of the header.
+    BODY,     //!< Counting body bytes.
+    COMPLETE  //!< The message is complete.
+  };
+
+  State m_state;                     //!< Current state.
+  std::vector<uint8_t> m_headerBuf;  //!< Reassembly buffer of the header.
+  HttpHeader m_header;               //!< Header of the current message.
+  uint32_t m_contentLength;          //!< Body length of the current message.
+  uint32_t m_bodyReceived;           //!< Body bytes of the current message received so far.
+};
+
+}
+
+#endif /* HTTP_STREAM_PARSER_H_ */
@@ -0,0 +1,141 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/pointer.h"
+#include "ns3/uinteger.h"
+#include "http-workload-arena.h"
+#include <vector>
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HttpWorkloadArena");
+
+NS_OBJECT_ENSURE_REGISTERED (HttpWorkloadArena);
+
+TypeId
+HttpWorkloadArena::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HttpWorkloadArena")
+    .SetParent<HttpWorkloadTrace> ()
+    .AddConstructor<HttpWorkloadArena> ()
+    .AddAttribute ("NumOfPages",
+                   "Number of pages sampled by Generate.",
+                   UintegerValue (10000),
+                   MakeUintegerAccessor (&HttpWorkloadArena::m_numOfPages),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MainObjectSize",
+                   "A RandomVariableStream used to pick the size of the main objects.",
+                   StringValue ("ns3::WeibullRandomVariable[Scale=19104.9|Shape=0.771807]"),
+                   MakePointerAccessor (&HttpWorkloadArena::m_mainObjectSizeStream),
+                   MakePointerChecker <RandomVariableStream>())
+    .AddAttribute ("NumOfInlineObjects",
+                   "A RandomVariableStream used to pick the number of inline objects of a web page.",
+                   StringValue ("ns3::ExponentialRandomVariable[Mean=31.9291]"),
+                   MakePointerAccessor (&HttpWorkloadArena::m_numOfInlineObjStream),
+                   MakePointerChecker <RandomVariableStream>())
+    .AddAttribute ("InlineObjectSize",
+                   "A RandomVariableStream used to pick the size of the inline objects.",
+                   StringValue ("ns3::LogNormalRandomVariable[Mu=8.91365|Sigma=1.24816]"),
+                   MakePointerAccessor (&HttpWorkloadArena::m_inlineObjectSizeStream),
+                   MakePointerChecker <RandomVariableStream>())
+    .AddAttribute ("ReadingTime",
+                   "A RandomVariableStream used to pick the reading time (in seconds) after each web page.",
+                   StringValue ("ns3::LogNormalRandomVariable[Mu=-0.495204|Sigma=2.7731]"),
+                   MakePointerAccessor (&HttpWorkloadArena::m_readingTimeStream),
+                   MakePointerChecker <RandomVariableStream>())
+  ;
+  return tid;
+}
+
+HttpWorkloadArena::HttpWorkloadArena ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HttpWorkloadArena::~HttpWorkloadArena ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HttpWorkloadArena::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_mainObjectSizeStream = 0;
+  m_numOfInlineObjStream = 0;
+  m_inlineObjectSizeStream = 0;
+  m_readingTimeStream = 0;
+  HttpWorkloadTrace::DoDispose ();
+}
+
+int64_t
+HttpWorkloadArena::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_mainObjectSizeStream->SetStream (stream);
+  m_numOfInlineObjStream->SetStream (stream + 1);
+  m_inlineObjectSizeStream->SetStream (stream + 2);
+  m_readingTimeStream->SetStream (stream + 3);
+  return 4;
+}
+
+void
+HttpWorkloadArena::Generate (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // One distribution at a time, so each loop stays on a single stream.
+  std::vector<uint32_t> mainObjectSizes (m_numOfPages);
+  for (uint32_t page = 0; page < m_numOfPages; page++)
+    {
+      mainObjectSizes[page] = m_mainObjectSizeStream->GetInteger ();
+    }
+
+  std::vector<uint32_t> numOfInlineObjects (m_numOfPages);
+  uint64_t totalInlineObjects = 0;
+  for (uint32_t page = 0; page < m_numOfPages; page++)
+    {
+      numOfInlineObjects[page] = m_numOfInlineObjStream->GetInteger ();
+      totalInlineObjects += numOfInlineObjects[page];
+    }
+
+  std::vector<uint32_t> inlineObjectSizes (totalInlineObjects);
+  for (uint64_t object = 0; object < totalInlineObjects; object++)
+    {
+      inlineObjectSizes[object] = m_inlineObjectSizeStream->GetInteger ();
+    }
+
+  //Limiting reading time to 10000 seconds according to paper "An HTTP Web Traffic
+  //Model Based on the Top One Million Visited Web Pages" by Rastin Pries et. al (Table II).
+  std::vector<double> readingTimes (m_numOfPages);
+  for (uint32_t page = 0; page < m_numOfPages; page++)
+    {
+      readingTimes[page] = std::min (m_readingTimeStream->GetValue (), 10000.0);
+    }
+
+  Build (readingTimes, mainObjectSizes, numOfInlineObjects, inlineObjectSizes);
+
+  NS_LOG_INFO ("HttpWorkloadArena >> " << m_numOfPages << " pages and "
+               << totalInlineObjects << " inline objects generated.");
+}
+
+}
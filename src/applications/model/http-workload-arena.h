@@ -0,0 +1,118 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#ifndef HTTP_WORKLOAD_ARENA_H_
+#define HTTP_WORKLOAD_ARENA_H_
+
+#include "ns3/http-workload-trace.h"
+#include "ns3/random-variable-stream.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup http
+ *
+ * Workload sampled up front from the Pries et al. distributions (or any
+ * RandomVariableStream) and replayed like a HttpWorkloadTrace. Generate
+ * draws the object sizes, inline object counts and reading times of
+ * NumOfPages pages in batches, one distribution at a time, and lays them
+ * out in one contiguous block in the trace format. The HttpServer and
+ * HttpClient then read the pages by index through their WorkloadTrace
+ * attribute, with no sampling on the event path.
+ *
+ * With fixed random variable streams, two runs comparing different
+ * network stacks offer byte-identical load:
+ * \code
+ *   Ptr<HttpWorkloadArena> arena = CreateObject<HttpWorkloadArena> ();
+ *   arena->SetAttribute ("NumOfPages", UintegerValue (100000));
+ *   arena->AssignStreams (1);
+ *   arena->Generate ();
+ *   httpServer.SetAttribute ("WorkloadTrace", PointerValue (arena));
+ *   httpClient.SetAttribute ("WorkloadTrace", PointerValue (arena));
+ * \endcode
+ */
+class HttpWorkloadArena : public HttpWorkloadTrace
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return type ID
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Constructor.
+   */
+  HttpWorkloadArena ();
+
+  /**
+   * \brief Destructor.
+   */
+  virtual ~HttpWorkloadArena ();
+
+  /**
+   * \brief Assign a fixed random variable stream number to the random variables
+   * used by this model.
+   * \param stream first stream index to use.
+   * \return the number of stream indices assigned by this model.
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * \brief Sample the pages of the workload. Any previous workload is
+   * released.
+   */
+  void Generate (void);
+
+protected:
+  /**
+   * \brief Dispose this object;
+   */
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Number of pages of the workload.
+   */
+  uint32_t m_numOfPages;
+
+  /**
+   * \brief Random Variable Stream for the size of main objects.
+   */
+  Ptr<RandomVariableStream> m_mainObjectSizeStream;
+
+  /**
+   * \brief Random Variable Stream for the number of inline objects.
+   */
+  Ptr<RandomVariableStream> m_numOfInlineObjStream;
+
+  /**
+   * \brief Random Variable Stream for the size of inline objects.
+   */
+  Ptr<RandomVariableStream> m_inlineObjectSizeStream;
+
+  /**
+   * \brief Random Variable Stream for the reading time (in seconds) after each page.
+   */
+  Ptr<RandomVariableStream> m_readingTimeStream;
+};
+
+}
+
+#endif /* HTTP_WORKLOAD_ARENA_H_ */
@@ -0,0 +1,432 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "http-workload-trace.h"
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HttpWorkloadTrace");
+
+NS_OBJECT_ENSURE_REGISTERED (HttpWorkloadTrace);
+
+namespace {
+
+const char TRACE_MAGIC[] = "HTTPTRC1";
+const uint32_t TRACE_VERSION = 1;
+const uint32_t FILE_HEADER_SIZE = 32;
+const uint32_t PAGE_HEADER_SIZE = 12;
+
+const char MAIN_OBJECT_URL[] = "main/object/";
+const char INLINE_OBJECT_URL[] = "inline/object/";
+
+uint32_t
+ReadU32 (const uint8_t *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t> (p[3]) << 24);
+}
+
+uint64_t
+ReadU64 (const uint8_t *p)
+{
+  return ReadU32 (p) | (static_cast<uint64_t> (ReadU32 (p + 4)) << 32);
+}
+
+void
+WriteU32 (std::ostream &os, uint32_t v)
+{
+  uint8_t b[4] = { uint8_t (v), uint8_t (v >> 8), uint8_t (v >> 16), uint8_t (v >> 24) };
+  os.write (reinterpret_cast<const char *> (b), sizeof (b));
+}
+
+void
+WriteU64 (std::ostream &os, uint64_t v)
+{
+  WriteU32 (os, v);
+  WriteU32 (os, v >> 32);
+}
+
+void
+PutU32 (uint8_t *p, uint32_t v)
+{
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+void
+PutU64 (uint8_t *p, uint64_t v)
+{
+  PutU32 (p, v);
+  PutU32 (p + 4, v >> 32);
+}
+
+/**
+ * \brief Parse an unsigned decimal number that fills a whole string.
+ * \param s the string.
+ * \param value the number, set on success.
+ * \return true on success.
+ */
+bool
+ParseDecimal (const char *s, uint64_t &value)
+{
+  if (*s < '0' || *s > '9')
+    {
+      return false;
+    }
+  char *end;
+  value = strtoull (s, &end, 10);
+  return *end == '\0';
+}
+
+} // anonymous namespace
+
+TypeId
+HttpWorkloadTrace::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HttpWorkloadTrace")
+    .SetParent<Object> ()
+    .AddConstructor<HttpWorkloadTrace> ()
+  ;
+  return tid;
+}
+
+HttpWorkloadTrace::HttpWorkloadTrace ()
+  : m_data (0),
+    m_size (0),
+    m_numPages (0),
+    m_index (0),
+    m_mapped (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HttpWorkloadTrace::~HttpWorkloadTrace ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+HttpWorkloadTrace::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  Object::DoDispose ();
+}
+
+void
+HttpWorkloadTrace::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_mapped)
+    {
+      munmap (const_cast<uint8_t *> (m_data), m_size);
+    }
+  m_mapped = false;
+  std::vector<uint8_t> ().swap (m_image);
+  m_data = 0;
+  m_size = 0;
+  m_numPages = 0;
+  m_index = 0;
+}
+
+void
+HttpWorkloadTrace::Open (std::string fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+
+  Close ();
+  m_fileName = fileName;
+
+  int fd = open (fileName.c_str (), O_RDONLY);
+  NS_ABORT_MSG_IF (fd < 0, "HttpWorkloadTrace >> Can't open file " << fileName);
+
+  struct stat st;
+  if (fstat (fd, &st) != 0 || st.st_size < FILE_HEADER_SIZE)
+    {
+      close (fd);
+      NS_FATAL_ERROR ("HttpWorkloadTrace >> " << fileName << " is not a workload trace.");
+    }
+
+  void *data = mmap (0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+  NS_ABORT_MSG_IF (data == MAP_FAILED, "HttpWorkloadTrace >> Can't map file " << fileName);
+
+  m_data = static_cast<const uint8_t *> (data);
+  m_size = st.st_size;
+  m_mapped = true;
+  ReadHeader ();
+
+  // Pages are mostly replayed in order.
+  madvise (data, m_size, MADV_SEQUENTIAL);
+
+  NS_LOG_INFO ("HttpWorkloadTrace >> " << fileName << ": " << m_numPages << " pages.");
+}
+
+void
+HttpWorkloadTrace::ReadHeader (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  NS_ABORT_MSG_IF (memcmp (m_data, TRACE_MAGIC, 8) != 0,
+                   "HttpWorkloadTrace >> " << m_fileName << " is not a workload trace.");
+  NS_ABORT_MSG_IF (ReadU32 (m_data + 8) != TRACE_VERSION,
+                   "HttpWorkloadTrace >> Unsupported version of " << m_fileName);
+
+  m_numPages = ReadU64 (m_data + 16);
+  uint64_t indexOffset = ReadU64 (m_data + 24);
+  NS_ABORT_MSG_IF (indexOffset < FILE_HEADER_SIZE || indexOffset > m_size
+                   || m_numPages > (m_size - indexOffset) / 8,
+                   "HttpWorkloadTrace >> " << m_fileName << " is truncated.");
+  m_index = m_data + indexOffset;
+}
+
+void
+HttpWorkloadTrace::Build (const std::vector<double> &readingTimes, const std::vector<uint32_t> &mainObjectSizes,
+                          const std::vector<uint32_t> &numOfInlineObjects, const std::vector<uint32_t> &inlineObjectSizes)
+{
+  NS_LOG_FUNCTION (this << mainObjectSizes.size () << inlineObjectSizes.size ());
+
+  NS_ASSERT (readingTimes.size () == mainObjectSizes.size ()
+             && numOfInlineObjects.size () == mainObjectSizes.size ());
+
+  Close ();
+  m_fileName = "(memory)";
+
+  // Laid out in place, with the same format as ConvertFromCsv, so the image
+  // is byte-identical to a converted file and held in memory only once.
+  uint64_t numPages = mainObjectSizes.size ();
+  uint64_t indexOffset = FILE_HEADER_SIZE + numPages * PAGE_HEADER_SIZE + 4 * inlineObjectSizes.size ();
+  m_image.resize (indexOffset + 8 * numPages);
+  uint8_t *image = &m_image[0];
+  std::copy (TRACE_MAGIC, TRACE_MAGIC + 8, image);
+  PutU32 (image + 8, TRACE_VERSION);
+  PutU32 (image + 12, 0);
+  PutU64 (image + 16, numPages);
+  PutU64 (image + 24, indexOffset);
+
+  uint64_t offset = FILE_HEADER_SIZE;
+  uint64_t object = 0;
+  for (uint64_t page = 0; page < numPages; page++)
+    {
+      NS_ASSERT (object + numOfInlineObjects[page] <= inlineObjectSizes.size ());
+      PutU64 (image + indexOffset + 8 * page, offset);
+      uint8_t *p = image + offset;
+      PutU32 (p, std::min (std::floor (readingTimes[page] * 1000 + 0.5), 4294967295.0));
+      PutU32 (p + 4, mainObjectSizes[page]);
+      PutU32 (p + 8, numOfInlineObjects[page]);
+      p += PAGE_HEADER_SIZE;
+      for (uint32_t i = 0; i < numOfInlineObjects[page]; i++, p += 4)
+        {
+          PutU32 (p, inlineObjectSizes[object++]);
+        }
+      offset += PAGE_HEADER_SIZE + 4 * numOfInlineObjects[page];
+    }
+  NS_ASSERT (offset == indexOffset);
+
+  m_data = &m_image[0];
+  m_size = m_image.size ();
+  ReadHeader ();
+}
+
+uint64_t
+HttpWorkloadTrace::GetNumPages (void) const
+{
+  return m_numPages;
+}
+
+const uint8_t *
+HttpWorkloadTrace::GetPage (uint64_t page) const
+{
+  NS_ABORT_MSG_IF (page >= m_numPages, "HttpWorkloadTrace >> Page " << page << " is not in the trace.");
+
+  uint64_t offset = ReadU64 (m_index + 8 * page);
+  uint64_t indexOffset = m_index - m_data;
+  NS_ABORT_MSG_IF (offset < FILE_HEADER_SIZE || offset + PAGE_HEADER_SIZE > indexOffset
+                   || ReadU32 (m_data + offset + 8) > (indexOffset - offset - PAGE_HEADER_SIZE) / 4,
+                   "HttpWorkloadTrace >> Page " << page << " of " << m_fileName << " is corrupt.");
+  return m_data + offset;
+}
+
+Time
+HttpWorkloadTrace::GetReadingTime (uint64_t page) const
+{
+  return MilliSeconds (ReadU32 (GetPage (page)));
+}
+
+uint32_t
+HttpWorkloadTrace::GetMainObjectSize (uint64_t page) const
+{
+  return ReadU32 (GetPage (page) + 4);
+}
+
+uint32_t
+HttpWorkloadTrace::GetNumOfInlineObjects (uint64_t page) const
+{
+  return ReadU32 (GetPage (page) + 8);
+}
+
+uint32_t
+HttpWorkloadTrace::GetInlineObjectSize (uint64_t page, uint32_t object) const
+{
+  const uint8_t *p = GetPage (page);
+  NS_ABORT_MSG_IF (object >= ReadU32 (p + 8),
+                   "HttpWorkloadTrace >> Page " << page << " has no inline object " << object);
+  return ReadU32 (p + PAGE_HEADER_SIZE + 4 * object);
+}
+
+uint64_t
+HttpWorkloadTrace::ConvertFromCsv (std::string csvFileName, std::string traceFileName)
+{
+  NS_LOG_FUNCTION (csvFileName << traceFileName);
+
+  std::ifstream csv (csvFileName.c_str ());
+  NS_ABORT_MSG_IF (!csv.is_open (), "HttpWorkloadTrace >> Can't open file " << csvFileName);
+  std::ofstream trace (traceFileName.c_str (), std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_IF (!trace.is_open (), "HttpWorkloadTrace >> Can't open file " << traceFileName);
+
+  // The header is written again with the final counts at the end.
+  trace.write (TRACE_MAGIC, 8);
+  WriteU32 (trace, TRACE_VERSION);
+  WriteU32 (trace, 0);
+  WriteU64 (trace, 0);
+  WriteU64 (trace, 0);
+
+  std::vector<uint64_t> offsets;
+  std::vector<uint32_t> sizes;
+  uint64_t offset = FILE_HEADER_SIZE;
+  std::string line;
+  std::string column;
+  uint64_t lineNumber = 0;
+  while (std::getline (csv, line))
+    {
+      lineNumber++;
+      if (!line.empty () && line[line.size () - 1] == '\r')
+        {
+          line.erase (line.size () - 1);
+        }
+      if (line.empty () || line[0] == '#')
+        {
+          continue;
+        }
+
+      std::istringstream columns (line);
+      std::getline (columns, column, ',');
+      char *end;
+      double readingTime = strtod (column.c_str (), &end);
+      NS_ABORT_MSG_IF (*end != '\0' || column.empty () || !(readingTime >= 0),
+                       "HttpWorkloadTrace >> " << csvFileName << ":" << lineNumber << ": bad reading time.");
+
+      sizes.clear ();
+      while (std::getline (columns, column, ','))
+        {
+          uint64_t size;
+          NS_ABORT_MSG_IF (!ParseDecimal (column.c_str (), size) || size > 0xffffffff,
+                           "HttpWorkloadTrace >> " << csvFileName << ":" << lineNumber << ": bad object size.");
+          sizes.push_back (size);
+        }
+      NS_ABORT_MSG_IF (sizes.empty (),
+                       "HttpWorkloadTrace >> " << csvFileName << ":" << lineNumber << ": no main object size.");
+
+      offsets.push_back (offset);
+      WriteU32 (trace, std::min (std::floor (readingTime * 1000 + 0.5), 4294967295.0));
+      WriteU32 (trace, sizes[0]);
+      WriteU32 (trace, sizes.size () - 1);
+      for (uint32_t i = 1; i < sizes.size (); i++)
+        {
+          WriteU32 (trace, sizes[i]);
+        }
+      offset += PAGE_HEADER_SIZE + 4 * (sizes.size () - 1);
+    }
+
+  for (std::vector<uint64_t>::const_iterator it = offsets.begin (); it != offsets.end (); ++it)
+    {
+      WriteU64 (trace, *it);
+    }
+
+  trace.seekp (16);
+  WriteU64 (trace, offsets.size ());
+  WriteU64 (trace, offset);
+  trace.close ();
+  NS_ABORT_MSG_IF (trace.fail (), "HttpWorkloadTrace >> Error writing " << traceFileName);
+
+  NS_LOG_INFO ("HttpWorkloadTrace >> " << offsets.size () << " pages written to " << traceFileName);
+  return offsets.size ();
+}
+
+std::string
+HttpWorkloadTrace::GetMainObjectUrl (uint64_t page)
+{
+  std::ostringstream url;
+  url << MAIN_OBJECT_URL << page;
+  return url.str ();
+}
+
+std::string
+HttpWorkloadTrace::GetInlineObjectUrl (uint64_t page, uint32_t object)
+{
+  std::ostringstream url;
+  url << INLINE_OBJECT_URL << page << "/" << object;
+  return url.str ();
+}
+
+bool
+HttpWorkloadTrace::ParseUrl (const std::string &url, uint64_t &page, uint32_t &object, bool &mainObject)
+{
+  if (url.compare (0, sizeof (MAIN_OBJECT_URL) - 1, MAIN_OBJECT_URL) == 0)
+    {
+      mainObject = true;
+      object = 0;
+      return ParseDecimal (url.c_str () + sizeof (MAIN_OBJECT_URL) - 1, page);
+    }
+
+  if (url.compare (0, sizeof (INLINE_OBJECT_URL) - 1, INLINE_OBJECT_URL) == 0)
+    {
+      std::string rest = url.substr (sizeof (INLINE_OBJECT_URL) - 1);
+      std::string::size_type slash = rest.find ('/');
+      uint64_t index;
+      if (slash == std::string::npos
+          || !ParseDecimal (rest.substr (slash + 1).c_str (), index) || index > 0xffffffff
+          || !ParseDecimal (rest.substr (0, slash).c_str (), page))
+        {
+          return false;
+        }
+      mainObject = false;
+      object = index;
+      return true;
+    }
+
+  return false;
+}
+
+}
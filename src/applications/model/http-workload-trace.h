@@ -0,0 +1,199 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#ifndef HTTP_WORKLOAD_TRACE_H_
+#define HTTP_WORKLOAD_TRACE_H_
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup http
+ *
+ * Read-only view of a binary HTTP workload trace, used to replay recorded
+ * page loads instead of sampling the Pries et al. distributions. Every page
+ * of the trace has a main object, its inline objects and the reading time
+ * that follows it.
+ *
+ * The file is memory-mapped, so only the pages actually replayed are read
+ * from disk, and traces larger than the RAM can be replayed. A single trace
+ * object can be shared by any number of HttpServer and HttpClient
+ * applications.
+ *
+ * File format (all integers little-endian):
+ * \verbatim
+   header     magic "HTTPTRC1" (8 bytes), version (u32), reserved (u32),
+              number of pages (u64), offset of the page index (u64)
+   page       reading time in ms (u32), main object size (u32),
+              number of inline objects n (u32), n inline object sizes (u32)
+   index      offset of each page (u64), in page order
+   \endverbatim
+ *
+ * Traces are written by ConvertFromCsv, from CSV files with one page per
+ * line:
+ * \verbatim
+   reading time (s),main object size,inline object size,inline object size,...
+   \endverbatim
+ */
+class HttpWorkloadTrace : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return type ID
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Constructor.
+   */
+  HttpWorkloadTrace ();
+
+  /**
+   * \brief Destructor.
+   */
+  virtual ~HttpWorkloadTrace ();
+
+  /**
+   * \brief Map a trace file. Any previously mapped file is released.
+   * \param fileName name of the trace file.
+   */
+  void Open (std::string fileName);
+
+  /**
+   * \brief Get the number of pages in the trace.
+   * \return the number of pages.
+   */
+  uint64_t GetNumPages (void) const;
+
+  /**
+   * \brief Get the reading time after a page.
+   * \param page page index, lower than GetNumPages.
+   * \return the reading time.
+   */
+  Time GetReadingTime (uint64_t page) const;
+
+  /**
+   * \brief Get the size of the main object of a page.
+   * \param page page index, lower than GetNumPages.
+   * \return the size in bytes.
+   */
+  uint32_t GetMainObjectSize (uint64_t page) const;
+
+  /**
+   * \brief Get the number of inline objects of a page.
+   * \param page page index, lower than GetNumPages.
+   * \return the number of inline objects.
+   */
+  uint32_t GetNumOfInlineObjects (uint64_t page) const;
+
+  /**
+   * \brief Get the size of an inline object of a page.
+   * \param page page index, lower than GetNumPages.
+   * \param object inline object index, lower than GetNumOfInlineObjects.
+   * \return the size in bytes.
+   */
+  uint32_t GetInlineObjectSize (uint64_t page, uint32_t object) const;
+
+  /**
+   * \brief Convert a CSV workload to the binary trace format. The CSV file
+   * is read line by line, so it may be larger than the RAM.
+   * \param csvFileName name of the CSV file.
+   * \param traceFileName name of the binary trace to write.
+   * \return the number of pages written.
+   */
+  static uint64_t ConvertFromCsv (std::string csvFileName, std::string traceFileName);
+
+  /**
+   * \brief Get the URL of the main object of a trace page.
+   * \param page page index.
+   * \return the URL.
+   */
+  static std::string GetMainObjectUrl (uint64_t page);
+
+  /**
+   * \brief Get the URL of an inline object of a trace page.
+   * \param page page index.
+   * \param object inline object index.
+   * \return the URL.
+   */
+  static std::string GetInlineObjectUrl (uint64_t page, uint32_t object);
+
+  /**
+   * \brief Parse a URL built by GetMainObjectUrl or GetInlineObjectUrl.
+   * \param url the URL.
+   * \param page the page index, set on success.
+   * \param object the inline object index, set on success for inline objects.
+   * \param mainObject true for a main object URL, set on success.
+   * \return true if the URL refers to a trace page.
+   */
+  static bool ParseUrl (const std::string &url, uint64_t &page, uint32_t &object, bool &mainObject);
+
+protected:
+  /**
+   * \brief Dispose this object;
+   */
+  virtual void DoDispose (void);
+
+  /**
+   * \brief Lay out pages in memory, in the trace format, instead of mapping
+   * a file. Any previously mapped file is released.
+   * \param readingTimes reading time (in seconds) after each page.
+   * \param mainObjectSizes main object size of each page.
+   * \param numOfInlineObjects number of inline objects of each page.
+   * \param inlineObjectSizes inline object sizes of all pages, page after page.
+   */
+  void Build (const std::vector<double> &readingTimes, const std::vector<uint32_t> &mainObjectSizes,
+              const std::vector<uint32_t> &numOfInlineObjects, const std::vector<uint32_t> &inlineObjectSizes);
+
+private:
+  /**
+   * \brief Release the mapped file or the pages built in memory.
+   */
+  void Close (void);
+
+  /**
+   * \brief Check the header of the trace data and locate its page index.
+   */
+  void ReadHeader (void);
+
+  /**
+   * \brief Get the record of a page.
+   * \param page page index.
+   * \return pointer to the first byte of the page record.
+   */
+  const uint8_t *GetPage (uint64_t page) const;
+
+  std::string m_fileName;  //!< Name of the mapped file.
+  const uint8_t *m_data;   //!< Start of the mapping.
+  uint64_t m_size;         //!< Size of the mapping.
+  uint64_t m_numPages;     //!< Number of pages.
+  const uint8_t *m_index;  //!< Start of the page index.
+  bool m_mapped;           //!< True if m_data is a mapped file.
+  std::vector<uint8_t> m_image;  //!< Pages laid out by Build.
+};
+
+}
+
+#endif /* HTTP_WORKLOAD_TRACE_H_ */
@@ -0,0 +1,220 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#include "ns3/test.h"
+#include "ns3/boolean.h"
+#include "ns3/http-empirical-random-variable.h"
+#include <fstream>
+#include <cstdio>
+#include <map>
+#include <string>
+
+using namespace ns3;
+
+namespace {
+
+const uint32_t NUM_SAMPLES = 100000; //!< Draws per distribution checked.
+
+/**
+ * \brief Create an HttpEmpiricalRandomVariable from the text of a CDF file.
+ * \param fileName name of the temporary CDF file.
+ * \param cdf lines of the CDF file.
+ * \param interpolate value of the Interpolate attribute.
+ * \return the random variable, with the CDF loaded.
+ */
+Ptr<HttpEmpiricalRandomVariable>
+CreateEmpirical (const std::string &fileName, const std::string &cdf, bool interpolate)
+{
+  {
+    std::ofstream file (fileName.c_str ());
+    file << cdf;
+  }
+  Ptr<HttpEmpiricalRandomVariable> rv = CreateObject<HttpEmpiricalRandomVariable> ();
+  rv->SetAttribute ("Interpolate", BooleanValue (interpolate));
+  rv->Load (fileName);
+  std::remove (fileName.c_str ());
+  return rv;
+}
+
+/**
+ * \brief Draw values and count how often each comes out.
+ * \param rv the random variable.
+ * \return the number of draws of each value.
+ */
+std::map<double, uint32_t>
+CountValues (Ptr<HttpEmpiricalRandomVariable> rv)
+{
+  std::map<double, uint32_t> counts;
+  for (uint32_t i = 0; i < NUM_SAMPLES; i++)
+    {
+      counts[rv->GetValue ()]++;
+    }
+  return counts;
+}
+
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief Check that a CDF ending below 1 is normalized.
+ */
+class HttpEmpiricalNormalizationTestCase : public TestCase
+{
+public:
+  HttpEmpiricalNormalizationTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+HttpEmpiricalNormalizationTestCase::HttpEmpiricalNormalizationTestCase ()
+  : TestCase ("Check that a CDF ending below 1 is normalized")
+{
+}
+
+void
+HttpEmpiricalNormalizationTestCase::DoRun (void)
+{
+  Ptr<HttpEmpiricalRandomVariable> rv =
+    CreateEmpirical (CreateTempDirFilename ("normalization.cdf"),
+                     "# value,cumulative probability\n10,0.1\n\n20,0.4\n", false);
+  NS_TEST_ASSERT_MSG_EQ (rv->GetNumBins (), 2, "Wrong number of bins");
+
+  std::map<double, uint32_t> counts = CountValues (rv);
+  NS_TEST_ASSERT_MSG_EQ (counts.size (), 2, "Value drawn outside the CDF points");
+  NS_TEST_ASSERT_MSG_EQ_TOL (counts[10] / double (NUM_SAMPLES), 0.25, 0.01, "Bin of 10 not normalized");
+  NS_TEST_ASSERT_MSG_EQ_TOL (counts[20] / double (NUM_SAMPLES), 0.75, 0.01, "Bin of 20 not normalized");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief Check that bins without probability mass are never drawn.
+ */
+class HttpEmpiricalZeroMassTestCase : public TestCase
+{
+public:
+  HttpEmpiricalZeroMassTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+HttpEmpiricalZeroMassTestCase::HttpEmpiricalZeroMassTestCase ()
+  : TestCase ("Check that bins without probability mass are never drawn")
+{
+}
+
+void
+HttpEmpiricalZeroMassTestCase::DoRun (void)
+{
+  std::string cdf = "1,0.5\n2,0.5\n3,0.5\n4,1\n";
+  Ptr<HttpEmpiricalRandomVariable> rv =
+    CreateEmpirical (CreateTempDirFilename ("zero-mass.cdf"), cdf, false);
+  NS_TEST_ASSERT_MSG_EQ (rv->GetNumBins (), 4, "Wrong number of bins");
+
+  std::map<double, uint32_t> counts = CountValues (rv);
+  NS_TEST_ASSERT_MSG_EQ (counts.count (2), 0, "Zero mass bin of 2 drawn");
+  NS_TEST_ASSERT_MSG_EQ (counts.count (3), 0, "Zero mass bin of 3 drawn");
+  NS_TEST_ASSERT_MSG_EQ_TOL (counts[1] / double (NUM_SAMPLES), 0.5, 0.01, "Wrong frequency of 1");
+
+  // Interpolated, the first bin returns its point and the last one spreads
+  // over [3, 4], so nothing comes out of the empty bins in between.
+  rv = CreateEmpirical (CreateTempDirFilename ("zero-mass.cdf"), cdf, true);
+  for (uint32_t i = 0; i < NUM_SAMPLES; i++)
+    {
+      double value = rv->GetValue ();
+      if (value != 1 && !(value >= 3 && value <= 4))
+        {
+          NS_TEST_ASSERT_MSG_EQ (value, 1, "Interpolated value drawn from an empty bin");
+          break;
+        }
+    }
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief Check that values are drawn with the probabilities of the CDF.
+ */
+class HttpEmpiricalFrequencyTestCase : public TestCase
+{
+public:
+  HttpEmpiricalFrequencyTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+HttpEmpiricalFrequencyTestCase::HttpEmpiricalFrequencyTestCase ()
+  : TestCase ("Check that values are drawn with the probabilities of the CDF")
+{
+}
+
+void
+HttpEmpiricalFrequencyTestCase::DoRun (void)
+{
+  Ptr<HttpEmpiricalRandomVariable> rv =
+    CreateEmpirical (CreateTempDirFilename ("frequency.cdf"), "1,0.1\n2,0.3\n3,0.6\n4,1\n", false);
+  std::map<double, uint32_t> counts = CountValues (rv);
+  NS_TEST_ASSERT_MSG_EQ (counts.size (), 4, "Value drawn outside the CDF points");
+  NS_TEST_ASSERT_MSG_EQ_TOL (counts[1] / double (NUM_SAMPLES), 0.1, 0.01, "Wrong frequency of 1");
+  NS_TEST_ASSERT_MSG_EQ_TOL (counts[2] / double (NUM_SAMPLES), 0.2, 0.01, "Wrong frequency of 2");
+  NS_TEST_ASSERT_MSG_EQ_TOL (counts[3] / double (NUM_SAMPLES), 0.3, 0.01, "Wrong frequency of 3");
+  NS_TEST_ASSERT_MSG_EQ_TOL (counts[4] / double (NUM_SAMPLES), 0.4, 0.01, "Wrong frequency of 4");
+
+  // Uniform between 0 and 10 when interpolated.
+  rv = CreateEmpirical (CreateTempDirFilename ("uniform.cdf"), "0,0\n10,1\n", true);
+  double sum = 0;
+  uint32_t below = 0;
+  for (uint32_t i = 0; i < NUM_SAMPLES; i++)
+    {
+      double value = rv->GetValue ();
+      sum += value;
+      below += value < 2.5;
+    }
+  NS_TEST_ASSERT_MSG_EQ_TOL (sum / NUM_SAMPLES, 5, 0.1, "Wrong mean of the interpolated values");
+  NS_TEST_ASSERT_MSG_EQ_TOL (below / double (NUM_SAMPLES), 0.25, 0.01, "Interpolated values not uniform");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief HttpEmpiricalRandomVariable TestSuite
+ */
+class HttpEmpiricalRandomVariableTestSuite : public TestSuite
+{
+public:
+  HttpEmpiricalRandomVariableTestSuite ();
+};
+
+HttpEmpiricalRandomVariableTestSuite::HttpEmpiricalRandomVariableTestSuite ()
+  : TestSuite ("http-empirical-random-variable", UNIT)
+{
+  AddTestCase (new HttpEmpiricalNormalizationTestCase, TestCase::QUICK);
+  AddTestCase (new HttpEmpiricalZeroMassTestCase, TestCase::QUICK);
+  AddTestCase (new HttpEmpiricalFrequencyTestCase, TestCase::QUICK);
+}
+
+static HttpEmpiricalRandomVariableTestSuite g_httpEmpiricalRandomVariableTestSuite; //!< Static variable for test initialization
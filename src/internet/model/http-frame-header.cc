@@ -0,0 +1,146 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "http-frame-header.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HttpFrameHeader");
+
+NS_OBJECT_ENSURE_REGISTERED (HttpFrameHeader);
+
+HttpFrameHeader::HttpFrameHeader ()
+  : m_length (0),
+    m_type (DATA),
+    m_flags (0),
+    m_streamId (0)
+{
+}
+
+void
+HttpFrameHeader::SetLength (uint32_t length)
+{
+  NS_ASSERT_MSG (length <= MAX_LENGTH, "HttpFrameHeader >> Payload of " << length << " bytes is too large.");
+  m_length = length;
+}
+
+uint32_t
+HttpFrameHeader::GetLength (void) const
+{
+  return m_length;
+}
+
+void
+HttpFrameHeader::SetType (Type type)
+{
+  m_type = type;
+}
+
+HttpFrameHeader::Type
+HttpFrameHeader::GetType (void) const
+{
+  return m_type;
+}
+
+void
+HttpFrameHeader::SetFlags (uint8_t flags)
+{
+  m_flags = flags;
+}
+
+uint8_t
+HttpFrameHeader::GetFlags (void) const
+{
+  return m_flags;
+}
+
+bool
+HttpFrameHeader::IsEndStream (void) const
+{
+  return (m_flags & END_STREAM) != 0;
+}
+
+void
+HttpFrameHeader::SetStreamId (uint32_t streamId)
+{
+  m_streamId = streamId & 0x7fffffff;
+}
+
+uint32_t
+HttpFrameHeader::GetStreamId (void) const
+{
+  return m_streamId;
+}
+
+TypeId
+HttpFrameHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HttpFrameHeader")
+    .SetParent<Header> ()
+    .AddConstructor<HttpFrameHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+HttpFrameHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+HttpFrameHeader::Print (std::ostream &os) const
+{
+  os << (m_type == HEADERS ? "HEADERS" : "DATA")
+     << " stream=" << m_streamId
+     << " length=" << m_length
+     << " flags=0x" << std::hex << static_cast<uint32_t> (m_flags) << std::dec;
+}
+
+uint32_t
+HttpFrameHeader::GetSerializedSize (void) const
+{
+  return SIZE;
+}
+
+void
+HttpFrameHeader::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteU8 ((m_length >> 16) & 0xff);
+  i.WriteHtonU16 (m_length & 0xffff);
+  i.WriteU8 (m_type);
+  i.WriteU8 (m_flags);
+  i.WriteHtonU32 (m_streamId);
+}
+
+uint32_t
+HttpFrameHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_length = i.ReadU8 () << 16;
+  m_length |= i.ReadNtohU16 ();
+  m_type = static_cast<Type> (i.ReadU8 ());
+  m_flags = i.ReadU8 ();
+  m_streamId = i.ReadNtohU32 () & 0x7fffffff;
+  return SIZE;
+}
+
+}
@@ -0,0 +1,163 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#ifndef HTTP_FRAME_HEADER_H_
+#define HTTP_FRAME_HEADER_H_
+
+#include "ns3/header.h"
+
+namespace ns3 {
+
+/**
+ * \class HttpFrameHeader.
+ * \brief Frame header of the multiplexed HTTP transport.
+ *
+ * The layout follows the 9-byte frame header of HTTP/2 (RFC 7540,
+ * section 4.1): a 24-bit payload length, a type, flags and a 31-bit stream
+ * identifier. Only the HEADERS and DATA frame types are used. A HEADERS
+ * frame carries a serialized HttpHeader. A DATA frame carries body bytes.
+ */
+class HttpFrameHeader : public Header
+{
+public:
+  /**
+   * \brief Frame types.
+   */
+  enum Type
+  {
+    DATA = 0x0,     //!< Body bytes of a stream.
+    HEADERS = 0x1   //!< HttpHeader of a request or response.
+  };
+
+  /**
+   * \brief Frame flags.
+   */
+  enum Flags
+  {
+    END_STREAM = 0x1,   //!< Last frame of the stream in this direction.
+    END_HEADERS = 0x4   //!< The frame holds the whole header block.
+  };
+
+  /**
+   * \brief Size of the serialized frame header.
+   */
+  static const uint32_t SIZE = 9;
+
+  /**
+   * \brief Largest payload length that can be encoded.
+   */
+  static const uint32_t MAX_LENGTH = 0xffffff;
+
+  /**
+   * \brief Construct a DATA frame header for stream 0.
+   */
+  HttpFrameHeader ();
+
+  /**
+   * \brief Set the payload length.
+   * \param length number of payload bytes following the frame header.
+   */
+  void SetLength (uint32_t length);
+
+  /**
+   * \brief Get the payload length.
+   * \return the number of payload bytes following the frame header.
+   */
+  uint32_t GetLength (void) const;
+
+  /**
+   * \brief Set the frame type.
+   * \param type the type.
+   */
+  void SetType (Type type);
+
+  /**
+   * \brief Get the frame type.
+   * \return the type.
+   */
+  Type GetType (void) const;
+
+  /**
+   * \brief Set the frame flags.
+   * \param flags bitwise OR of Flags values.
+   */
+  void SetFlags (uint8_t flags);
+
+  /**
+   * \brief Get the frame flags.
+   * \return bitwise OR of Flags values.
+   */
+  uint8_t GetFlags (void) const;
+
+  /**
+   * \brief Check if the END_STREAM flag is set.
+   * \return true for the last frame of a stream.
+   */
+  bool IsEndStream (void) const;
+
+  /**
+   * \brief Set the stream identifier.
+   * \param streamId the identifier (31 bits).
+   */
+  void SetStreamId (uint32_t streamId);
+
+  /**
+   * \brief Get the stream identifier.
+   * \return the identifier.
+   */
+  uint32_t GetStreamId (void) const;
+
+  /**
+   * \brief Print some informations about the header.
+   * \param os output stream.
+   */
+  virtual void Print (std::ostream &os) const;
+
+  /**
+   * \brief Serialize the header.
+   * \param start Buffer iterator.
+   */
+  virtual void Serialize (Buffer::Iterator start) const;
+
+  /**
+   * \brief Deserialize the header.
+   * \param start Buffer iterator.
+   * \return number of bytes consumed.
+   */
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+  /**
+   * \brief Get the serialized size of the header.
+   * \return size.
+   */
+  virtual uint32_t GetSerializedSize (void) const;
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+private:
+  uint32_t m_length;    //!< Payload length.
+  Type m_type;          //!< Frame type.
+  uint8_t m_flags;      //!< Frame flags.
+  uint32_t m_streamId;  //!< Stream identifier.
+};
+
+}
+
+#endif /* HTTP_FRAME_HEADER_H_ */
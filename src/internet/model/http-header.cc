@@ -19,6 +19,10 @@
 
 #include "ns3/log.h"
 #include "http-header.h"
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <cstdlib>
 
 
 NS_LOG_COMPONENT_DEFINE ("HttpHeader");
@@ -29,13 +33,300 @@ namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED (HttpHeader);
 
+/**
+ * Names of the header fields stored in typed slots.
+ */
+static const char CONTENT_LENGTH_NAME[] = "ContentLength";
+static const char CONTENT_TYPE_NAME[] = "ContentType";
+static const char NUM_OF_INLINE_OBJECTS_NAME[] = "NumOfInlineObjects";
+
+/**
+ * \brief Get the number of decimal digits of a value.
+ * \param value the value.
+ * \return the number of digits.
+ */
+static uint32_t
+DecimalDigits (uint32_t value)
+{
+  uint32_t digits = 1;
+  while (value >= 10)
+    {
+      value /= 10;
+      digits++;
+    }
+  return digits;
+}
+
+/**
+ * \brief Write a value in decimal without going through a string.
+ * \param i buffer iterator.
+ * \param value the value.
+ */
+static void
+WriteDecimal (Buffer::Iterator &i, uint32_t value)
+{
+  uint8_t digits[10];
+  uint32_t n = 0;
+  do
+    {
+      digits[n++] = '0' + value % 10;
+      value /= 10;
+    } while (value != 0);
+
+  while (n > 0)
+    {
+      i.WriteU8 (digits[--n]);
+    }
+}
+
+/**
+ * \brief Write a string without its terminating NULL byte.
+ * \param i buffer iterator.
+ * \param str the string.
+ */
+static void
+WriteString (Buffer::Iterator &i, const std::string &str)
+{
+  i.Write (reinterpret_cast<const uint8_t *> (str.data ()), str.size ());
+}
+
+/**
+ * \brief Write a NULL terminated string without its terminating NULL byte.
+ * \param i buffer iterator.
+ * \param str the string.
+ */
+static void
+WriteString (Buffer::Iterator &i, const char *str)
+{
+  i.Write (reinterpret_cast<const uint8_t *> (str), strlen (str));
+}
+
+/**
+ * \brief Write a "name: " header field prefix.
+ * \param i buffer iterator.
+ * \param name the header field name.
+ */
+template <typename Name>
+static void
+WriteFieldName (Buffer::Iterator &i, const Name &name)
+{
+  WriteString (i, name);
+  i.WriteU8 (':');
+  i.WriteU8 (' ');
+}
+
+/**
+ * \brief Check if a parsed header field name is a given known name.
+ * \param known the known name.
+ * \param name the parsed name, not NULL terminated.
+ * \param length length of the parsed name.
+ * \return true if both names are equal.
+ */
+static bool
+IsFieldName (const char *known, const char *name, uint32_t length)
+{
+  return strlen (known) == length && memcmp (known, name, length) == 0;
+}
+
+/**
+ * \brief Write a CR/LF pair.
+ * \param i buffer iterator.
+ */
+static void
+WriteCrLf (Buffer::Iterator &i)
+{
+  i.WriteU8 ('\r');
+  i.WriteU8 ('\n');
+}
+
+const uint32_t HttpHeader::MAX_HEADER_SIZE;
+const uint32_t HttpHeader::MAX_FIELD_NAME_SIZE;
+
+namespace {
+
+/**
+ * \brief Reads the bytes of a header one at a time, never past a limit.
+ */
+template <typename Source>
+class HeaderReader
+{
+public:
+  /**
+   * \brief Constructor.
+   * \param source the bytes, read with ReadU8.
+   * \param available number of bytes available in the source.
+   */
+  HeaderReader (Source source, uint32_t available)
+    : m_source (source),
+      m_available (available),
+      m_limit (std::min (available, HttpHeader::MAX_HEADER_SIZE)),
+      m_consumed (0)
+  {
+  }
+
+  /**
+   * \brief Read the next byte.
+   * \param c the byte read.
+   * \return false if the limit has been reached.
+   */
+  bool Next (uint8_t &c)
+  {
+    if (m_consumed == m_limit)
+      {
+        return false;
+      }
+    c = m_source.ReadU8 ();
+    m_consumed++;
+    return true;
+  }
+
+  /**
+   * \brief Get the status to report when the bytes ran out.
+   * \return PARSE_TOO_LARGE if more bytes were available, PARSE_INCOMPLETE otherwise.
+   */
+  HttpHeader::ParseStatus OutOfBytes (void) const
+  {
+    return m_available > m_limit ? HttpHeader::PARSE_TOO_LARGE : HttpHeader::PARSE_INCOMPLETE;
+  }
+
+  /**
+   * \brief Get the number of bytes read.
+   * \return the number of bytes read.
+   */
+  uint32_t GetConsumed (void) const
+  {
+    return m_consumed;
+  }
+
+private:
+  Source m_source;       //!< The bytes.
+  uint32_t m_available;  //!< Bytes available in the source.
+  uint32_t m_limit;      //!< Bytes that may be read.
+  uint32_t m_consumed;   //!< Bytes read.
+};
+
+/**
+ * \brief Byte source over a contiguous array.
+ */
+class ArraySource
+{
+public:
+  /**
+   * \brief Constructor.
+   * \param data the bytes.
+   */
+  ArraySource (const uint8_t *data)
+    : m_data (data)
+  {
+  }
+
+  /**
+   * \brief Read the next byte.
+   * \return the byte.
+   */
+  uint8_t ReadU8 (void)
+  {
+    return *m_data++;
+  }
+
+private:
+  const uint8_t *m_data;  //!< Next byte.
+};
+
+} // anonymous namespace
+
+/**
+ * \brief Read a token up to a delimiter, which is consumed but not stored.
+ * \param reader bounded byte reader.
+ * \param delimiter byte that ends the token.
+ * \param token the token read.
+ * \return the parse status.
+ */
+template <typename Reader>
+static HttpHeader::ParseStatus
+ReadToken (Reader &reader, uint8_t delimiter, std::string &token)
+{
+  token.clear ();
+  uint8_t c;
+  while (reader.Next (c))
+    {
+      if (c == delimiter)
+        {
+          return HttpHeader::PARSE_OK;
+        }
+      if (c == '\r' || c == '\n' || c == 0)
+        {
+          return HttpHeader::PARSE_MALFORMED;
+        }
+      token.push_back (c);
+    }
+  return reader.OutOfBytes ();
+}
+
+/**
+ * \brief Read a decimal value up to a CR.
+ * \param reader bounded byte reader.
+ * \param value the value read.
+ * \return the parse status.
+ */
+template <typename Reader>
+static HttpHeader::ParseStatus
+ReadDecimal (Reader &reader, uint32_t &value)
+{
+  uint64_t v = 0;
+  uint32_t digits = 0;
+  uint8_t c;
+  while (reader.Next (c))
+    {
+      if (c == '\r')
+        {
+          value = v;
+          return digits > 0 ? HttpHeader::PARSE_OK : HttpHeader::PARSE_MALFORMED;
+        }
+      if (c < '0' || c > '9')
+        {
+          return HttpHeader::PARSE_MALFORMED;
+        }
+      v = v * 10 + (c - '0');
+      if (v > 0xffffffff)
+        {
+          return HttpHeader::PARSE_MALFORMED;
+        }
+      digits++;
+    }
+  return reader.OutOfBytes ();
+}
+
+/**
+ * \brief Read a byte that must have a given value.
+ * \param reader bounded byte reader.
+ * \param expected the expected value.
+ * \return the parse status.
+ */
+template <typename Reader>
+static HttpHeader::ParseStatus
+Expect (Reader &reader, uint8_t expected)
+{
+  uint8_t c;
+  if (!reader.Next (c))
+    {
+      return reader.OutOfBytes ();
+    }
+  return c == expected ? HttpHeader::PARSE_OK : HttpHeader::PARSE_MALFORMED;
+}
+
 HttpHeader::HttpHeader ()
-  : m_request(true),
+  : m_parseStatus(PARSE_OK),
+    m_request(true),
     m_method(""),
     m_url(""),
     m_version(""),
     m_statusCode(""),
-    m_phrase("")
+    m_phrase(""),
+    m_fields(0),
+    m_contentLength(0),
+    m_contentType(NO_CONTENT_TYPE),
+    m_numOfInlineObjects(0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -125,46 +416,166 @@ HttpHeader::GetPhrase (void) const
   return m_phrase;
 }
 
+void
+HttpHeader::SetContentLength (uint32_t contentLength)
+{
+  NS_LOG_FUNCTION (this << contentLength);
+  m_contentLength = contentLength;
+  m_fields |= CONTENT_LENGTH_FIELD;
+}
+
+uint32_t
+HttpHeader::GetContentLength (void) const
+{
+  return m_contentLength;
+}
+
+void
+HttpHeader::SetContentType (ContentType contentType)
+{
+  NS_LOG_FUNCTION (this << contentType);
+  m_contentType = contentType;
+  if (contentType == NO_CONTENT_TYPE)
+    {
+      m_fields &= ~CONTENT_TYPE_FIELD;
+    }
+  else
+    {
+      m_fields |= CONTENT_TYPE_FIELD;
+    }
+}
+
+HttpHeader::ContentType
+HttpHeader::GetContentType (void) const
+{
+  return m_contentType;
+}
+
+void
+HttpHeader::SetNumOfInlineObjects (uint32_t numOfInlineObjects)
+{
+  NS_LOG_FUNCTION (this << numOfInlineObjects);
+  m_numOfInlineObjects = numOfInlineObjects;
+  m_fields |= NUM_OF_INLINE_OBJECTS_FIELD;
+}
+
+uint32_t
+HttpHeader::GetNumOfInlineObjects (void) const
+{
+  return m_numOfInlineObjects;
+}
+
+const char *
+HttpHeader::ContentTypeToString (ContentType contentType)
+{
+  switch (contentType)
+    {
+    case MAIN_OBJECT:
+      return "main/object";
+    case INLINE_OBJECT:
+      return "inline/object";
+    default:
+      return "";
+    }
+}
+
 void
 HttpHeader::SetHeaderField (std::string headerFieldName, std::string headerFieldValue)
 {
     NS_LOG_FUNCTION (this << headerFieldName << ": " << headerFieldValue);
-    m_headerFieldMap.insert (std::pair<std::string, std::string>(headerFieldName, headerFieldValue));
+
+    if (headerFieldName == CONTENT_LENGTH_NAME)
+      {
+        SetContentLength (strtoul (headerFieldValue.c_str (), 0, 10));
+        return;
+      }
+    if (headerFieldName == NUM_OF_INLINE_OBJECTS_NAME)
+      {
+        SetNumOfInlineObjects (strtoul (headerFieldValue.c_str (), 0, 10));
+        return;
+      }
+    if (headerFieldName == CONTENT_TYPE_NAME)
+      {
+        if (headerFieldValue == ContentTypeToString (MAIN_OBJECT))
+          {
+            SetContentType (MAIN_OBJECT);
+            return;
+          }
+        if (headerFieldValue == ContentTypeToString (INLINE_OBJECT))
+          {
+            SetContentType (INLINE_OBJECT);
+            return;
+          }
+        // Other content types are kept as strings.
+        SetContentType (NO_CONTENT_TYPE);
+      }
+
+    std::vector<std::pair<std::string, std::string> >::iterator it;
+    for (it = m_otherFields.begin (); it != m_otherFields.end (); it++)
+      {
+        if (it->first == headerFieldName)
+          {
+            it->second = headerFieldValue;
+            return;
+          }
+      }
+    m_otherFields.push_back (std::make_pair (headerFieldName, headerFieldValue));
 }
 
 void
 HttpHeader::SetHeaderField (std::string headerFieldName, uint32_t headerFieldValue)
 {
     NS_LOG_FUNCTION (this << headerFieldName << ": " << headerFieldValue);
-    std::stringstream ss;
-    ss  << headerFieldValue;
-    m_headerFieldMapIt = m_headerFieldMap.find(headerFieldName);
-    if(m_headerFieldMapIt == m_headerFieldMap.end())
+
+    if (headerFieldName == CONTENT_LENGTH_NAME)
+      {
+        SetContentLength (headerFieldValue);
+      }
+    else if (headerFieldName == NUM_OF_INLINE_OBJECTS_NAME)
       {
-        m_headerFieldMap.insert (std::pair<std::string, std::string>(headerFieldName, ss.str()));
+        SetNumOfInlineObjects (headerFieldValue);
       }
     else
       {
-        m_headerFieldMapIt->second = ss.str();
+        char value[11];
+        snprintf (value, sizeof (value), "%u", headerFieldValue);
+        SetHeaderField (headerFieldName, std::string (value));
       }
 }
 
 std::string
-HttpHeader::GetHeaderField (std::string headerFieldName)
+HttpHeader::GetHeaderField (std::string headerFieldName) const
 {
     NS_LOG_FUNCTION (this << headerFieldName);
 
-    m_headerFieldMapIt = m_headerFieldMap.find(headerFieldName);
-    if(m_headerFieldMapIt != m_headerFieldMap.end())
+    char value[11];
+    if (headerFieldName == CONTENT_LENGTH_NAME && (m_fields & CONTENT_LENGTH_FIELD))
       {
-          return m_headerFieldMapIt->second;
+        snprintf (value, sizeof (value), "%u", m_contentLength);
+        return value;
       }
-    else
+    if (headerFieldName == NUM_OF_INLINE_OBJECTS_NAME && (m_fields & NUM_OF_INLINE_OBJECTS_FIELD))
+      {
+        snprintf (value, sizeof (value), "%u", m_numOfInlineObjects);
+        return value;
+      }
+    if (headerFieldName == CONTENT_TYPE_NAME && (m_fields & CONTENT_TYPE_FIELD))
       {
-          NS_LOG_ERROR("Header Field: " << headerFieldName <<
-                                 " does not exist. It has not been set by the remote side.");
-          return "";
+        return ContentTypeToString (m_contentType);
       }
+
+    std::vector<std::pair<std::string, std::string> >::const_iterator it;
+    for (it = m_otherFields.begin (); it != m_otherFields.end (); it++)
+      {
+        if (it->first == headerFieldName)
+          {
+            return it->second;
+          }
+      }
+
+    NS_LOG_ERROR("Header Field: " << headerFieldName <<
+                 " does not exist. It has not been set by the remote side.");
+    return "";
 }
 
 TypeId
@@ -203,10 +614,23 @@ HttpHeader::Print (std::ostream &os) const
                << "Phrase:" << m_phrase << "\n"
                ;
 
-      std::map<std::string, std::string>::const_iterator it = m_headerFieldMap.begin();
-      for(it = m_headerFieldMap.begin(); it != m_headerFieldMap.end(); it++)
+      if (m_fields & CONTENT_LENGTH_FIELD)
+        {
+          os << CONTENT_LENGTH_NAME << ": " << m_contentLength << "\n";
+        }
+      if (m_fields & CONTENT_TYPE_FIELD)
+        {
+          os << CONTENT_TYPE_NAME << ": " << ContentTypeToString (m_contentType) << "\n";
+        }
+      if (m_fields & NUM_OF_INLINE_OBJECTS_FIELD)
+        {
+          os << NUM_OF_INLINE_OBJECTS_NAME << ": " << m_numOfInlineObjects << "\n";
+        }
+
+      std::vector<std::pair<std::string, std::string> >::const_iterator it;
+      for(it = m_otherFields.begin(); it != m_otherFields.end(); it++)
         {
-          os << it->first.length() << ": " << it->second.length() << "\n";
+          os << it->first << ": " << it->second << "\n";
         }
     }
 }
@@ -225,10 +649,23 @@ HttpHeader::GetSerializedSize (void) const
     {
       //                                                                                                             spaces + CR/LF
       uint32_t size = m_version.length() + m_statusCode.length() + m_phrase.length() + 2    +     2;
-      std::map<std::string, std::string>::const_iterator it = m_headerFieldMap.begin();
-      for(it = m_headerFieldMap.begin(); it != m_headerFieldMap.end(); it++)
+      //                                       space/dots                          CR/LF
+      if (m_fields & CONTENT_LENGTH_FIELD)
+        {
+          size += (sizeof (CONTENT_LENGTH_NAME) - 1) +       2     + DecimalDigits (m_contentLength) +  2;
+        }
+      if (m_fields & CONTENT_TYPE_FIELD)
+        {
+          size += (sizeof (CONTENT_TYPE_NAME) - 1) +         2     + strlen (ContentTypeToString (m_contentType)) +  2;
+        }
+      if (m_fields & NUM_OF_INLINE_OBJECTS_FIELD)
+        {
+          size += (sizeof (NUM_OF_INLINE_OBJECTS_NAME) - 1) + 2    + DecimalDigits (m_numOfInlineObjects) +  2;
+        }
+
+      std::vector<std::pair<std::string, std::string> >::const_iterator it;
+      for(it = m_otherFields.begin(); it != m_otherFields.end(); it++)
         {
-          //                                space/dots                              CR/LF
           size += it->first.length()  +    2     + it->second.length() +  2;
         }
 
@@ -244,124 +681,201 @@ void
 HttpHeader::Serialize (Buffer::Iterator start) const
 {
   NS_LOG_FUNCTION_NOARGS ();
+  Buffer::Iterator i = start;
 
   if(m_request)
     {
-      std::string requestLine = m_method + " " + m_url + " " + m_version + "\r\n\r\n";
-      char tmpBuffer [requestLine.length() + 1];
-      strcpy (tmpBuffer, requestLine.c_str());
-      start.Write ((uint8_t *)tmpBuffer, strlen(tmpBuffer) + 1);
+      // method SP url SP version CR/LF CR/LF NULL
+      WriteString (i, m_method);
+      i.WriteU8 (' ');
+      WriteString (i, m_url);
+      i.WriteU8 (' ');
+      WriteString (i, m_version);
+      WriteCrLf (i);
     }
   else
     {
-      std::string statusLine = m_version + " " + m_statusCode + " " + m_phrase + "\r\n";
-
-      std::map<std::string, std::string>::const_iterator it = m_headerFieldMap.begin();
-      for(it = m_headerFieldMap.begin(); it != m_headerFieldMap.end(); it++)
+      // version SP status-code SP phrase CR/LF
+      WriteString (i, m_version);
+      i.WriteU8 (' ');
+      WriteString (i, m_statusCode);
+      i.WriteU8 (' ');
+      WriteString (i, m_phrase);
+      WriteCrLf (i);
+
+      // header-field-name: header-field-value CR/LF
+      if (m_fields & CONTENT_LENGTH_FIELD)
         {
-          statusLine += it->first + ": " + it->second + "\r\n";
+          WriteFieldName (i, CONTENT_LENGTH_NAME);
+          WriteDecimal (i, m_contentLength);
+          WriteCrLf (i);
+        }
+      if (m_fields & CONTENT_TYPE_FIELD)
+        {
+          WriteFieldName (i, CONTENT_TYPE_NAME);
+          WriteString (i, ContentTypeToString (m_contentType));
+          WriteCrLf (i);
+        }
+      if (m_fields & NUM_OF_INLINE_OBJECTS_FIELD)
+        {
+          WriteFieldName (i, NUM_OF_INLINE_OBJECTS_NAME);
+          WriteDecimal (i, m_numOfInlineObjects);
+          WriteCrLf (i);
         }
 
-      statusLine += "\r\n";
-
-      char tmpBuffer [statusLine.length() + 1];
-      strcpy (tmpBuffer, statusLine.c_str());
-      start.Write ((uint8_t *)tmpBuffer, strlen(tmpBuffer) + 1);
+      std::vector<std::pair<std::string, std::string> >::const_iterator it;
+      for(it = m_otherFields.begin(); it != m_otherFields.end(); it++)
+        {
+          WriteFieldName (i, it->first);
+          WriteString (i, it->second);
+          WriteCrLf (i);
+        }
     }
+
+  // CR/LF + NULL
+  WriteCrLf (i);
+  i.WriteU8 (0);
 }
 
 
-uint32_t
-HttpHeader::Deserialize (Buffer::Iterator start)
+template <typename Reader>
+HttpHeader::ParseStatus
+HttpHeader::DoParse (Reader &reader)
 {
-  NS_LOG_FUNCTION_NOARGS ();
-  Buffer::Iterator i = start;
-  uint8_t c;
-  uint32_t len = 0;
+  ParseStatus status;
+  std::string firstField;
 
-  do
+  // Start line: "method SP url SP version" or "version SP status-code SP phrase".
+  if ((status = ReadToken (reader, ' ', firstField)) != PARSE_OK)
     {
-      c  = i.ReadU8 ();
-      len++;
-    } while (c != 0);
-
-
-  char tmpBuffer [len];
-  start.Read ((uint8_t*)tmpBuffer, len);
-
-
-  std::string tmpString = tmpBuffer;
-  uint16_t begin = 0;
-  uint16_t end = tmpString.find_first_of (" ");
-  std::string firstField = tmpString.substr (begin, end - begin);
-
-  if(firstField == "GET")
-    m_request = true;
-  else
-    m_request = false;
+      return status;
+    }
 
-  if(m_request)
+  m_request = firstField.compare (0, 5, "HTTP/") != 0;
+  if (m_request)
     {
       m_method = firstField;
-      begin = end + 1;
-      end = tmpString.find_first_of (" ", begin);
-
-      m_url = tmpString.substr (begin, end - begin);
-      begin = end + 1;
-      end = tmpString.find_first_of (" ", begin);
-
-      m_version = tmpString.substr (begin, end - begin);
+      if ((status = ReadToken (reader, ' ', m_url)) != PARSE_OK
+          || (status = ReadToken (reader, '\r', m_version)) != PARSE_OK)
+        {
+          return status;
+        }
     }
   else
     {
       m_version = firstField;
+      if ((status = ReadToken (reader, ' ', m_statusCode)) != PARSE_OK
+          || (status = ReadToken (reader, '\r', m_phrase)) != PARSE_OK)
+        {
+          return status;
+        }
+    }
+  if ((status = Expect (reader, '\n')) != PARSE_OK)
+    {
+      return status;
+    }
 
-      begin = end + 1;
-      end = tmpString.find_first_of (" ", begin);
-      m_statusCode = tmpString.substr (begin, end - begin);
-
-      begin = end + 1;
-      end = tmpString.find_first_of ("\r", begin);
-      m_phrase = tmpString.substr (begin, end - begin);
-
-
-      size_t cr = tmpString.find_first_of("\r");
-      while (cr != std::string::npos)
+  // Header fields: "name: value" CR/LF, up to an empty line and the NULL byte.
+  // The typed slots are reset with the bitmask, so a reused header never
+  // reports the fields of the previous message.
+  m_fields = 0;
+  m_contentLength = 0;
+  m_contentType = NO_CONTENT_TYPE;
+  m_numOfInlineObjects = 0;
+  m_otherFields.clear ();
+
+  char name[MAX_FIELD_NAME_SIZE];
+  std::string value;
+  uint8_t c;
+  while (true)
+    {
+      uint32_t nameLength = 0;
+      while (true)
         {
-          begin = cr + 2;
-          end = tmpString.find_first_of("\r", begin);
-          if (begin != end)
+          if (!reader.Next (c))
             {
-              std::string headerField = tmpString.substr(begin, end - begin);
-
-              end=  headerField.find_first_of(":");
-              begin = end + 2;
-              std::string headerFieldName = headerField.substr(0, end);
-              end = headerField.find_first_of(":", begin);
-              std::string headerFieldValue = headerField.substr(begin, end - begin);
-
-              m_headerFieldMapIt = m_headerFieldMap.find(headerFieldName);
-              if(m_headerFieldMapIt == m_headerFieldMap.end())
-                {
-                  m_headerFieldMap.insert (std::pair<std::string, std::string>(headerFieldName, headerFieldValue));
-                }
-              else
+              return reader.OutOfBytes ();
+            }
+          if (c == ':')
+            {
+              break;
+            }
+          if (c == '\r' && nameLength == 0)
+            {
+              // End of the header.
+              if ((status = Expect (reader, '\n')) != PARSE_OK)
                 {
-                  m_headerFieldMapIt->second = headerFieldValue;
+                  return status;
                 }
+              return Expect (reader, 0);
+            }
+          if (c == '\r' || c == '\n' || c == 0 || nameLength == MAX_FIELD_NAME_SIZE)
+            {
+              return PARSE_MALFORMED;
+            }
+          name[nameLength++] = c;
+        }
+
+      if ((status = Expect (reader, ' ')) != PARSE_OK)
+        {
+          return status;
+        }
 
-              cr = tmpString.find_first_of("\r", tmpString.find_first_of("\r", cr + 2));
+      if (IsFieldName (CONTENT_LENGTH_NAME, name, nameLength))
+        {
+          if ((status = ReadDecimal (reader, m_contentLength)) != PARSE_OK)
+            {
+              return status;
+            }
+          m_fields |= CONTENT_LENGTH_FIELD;
+        }
+      else if (IsFieldName (NUM_OF_INLINE_OBJECTS_NAME, name, nameLength))
+        {
+          if ((status = ReadDecimal (reader, m_numOfInlineObjects)) != PARSE_OK)
+            {
+              return status;
             }
-          else
+          m_fields |= NUM_OF_INLINE_OBJECTS_FIELD;
+        }
+      else
+        {
+          if ((status = ReadToken (reader, '\r', value)) != PARSE_OK)
             {
-              cr = std::string::npos;
+              return status;
             }
-         }
+          SetHeaderField (std::string (name, nameLength), value);
+        }
+
+      if ((status = Expect (reader, '\n')) != PARSE_OK)
+        {
+          return status;
+        }
     }
+}
 
-  return GetSerializedSize ();
+uint32_t
+HttpHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  HeaderReader<Buffer::Iterator> reader (start, start.GetRemainingSize ());
+  m_parseStatus = DoParse (reader);
+  return m_parseStatus == PARSE_OK ? reader.GetConsumed () : 0;
 }
 
+uint32_t
+HttpHeader::Parse (const uint8_t *data, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  HeaderReader<ArraySource> reader (ArraySource (data), size);
+  m_parseStatus = DoParse (reader);
+  return m_parseStatus == PARSE_OK ? reader.GetConsumed () : 0;
+}
 
+HttpHeader::ParseStatus
+HttpHeader::GetParseStatus (void) const
+{
+  return m_parseStatus;
 }
 
+
+}
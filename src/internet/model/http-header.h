@@ -22,7 +22,8 @@
 #define HTTP_HEADER_H_
 
 #include "ns3/header.h"
-#include <map>
+#include <string>
+#include <vector>
 
 //using namespace std;
 
@@ -31,10 +32,46 @@ namespace ns3 {
 /**
  * \class HttpHeader.
  * \brief Packet header for HTTP.
+ *
+ * The header fields known by the traffic generator (ContentLength,
+ * ContentType and NumOfInlineObjects) are stored as typed values in fixed
+ * slots. Any other header field falls back to a small list of name/value
+ * strings.
  */
 class HttpHeader :public Header
 {
 public:
+  /**
+   * \brief Values of the ContentType header field.
+   */
+  enum ContentType
+  {
+    NO_CONTENT_TYPE = 0,  //!< ContentType field not set.
+    MAIN_OBJECT,          //!< "main/object"
+    INLINE_OBJECT         //!< "inline/object"
+  };
+
+  /**
+   * \brief Result of the last Deserialize or Parse call.
+   */
+  enum ParseStatus
+  {
+    PARSE_OK = 0,      //!< A complete header was parsed.
+    PARSE_INCOMPLETE,  //!< The input ended before the end of the header.
+    PARSE_MALFORMED,   //!< The input is not a valid header.
+    PARSE_TOO_LARGE    //!< The header is larger than MAX_HEADER_SIZE.
+  };
+
+  /**
+   * \brief Largest header accepted by Deserialize and Parse.
+   */
+  static const uint32_t MAX_HEADER_SIZE = 16384;
+
+  /**
+   * \brief Largest header field name accepted by Deserialize and Parse.
+   */
+  static const uint32_t MAX_FIELD_NAME_SIZE = 64;
+
   /**
    * \brief Construct a null HTTP header.
    */
@@ -112,6 +149,49 @@ public:
    */
   std::string GetPhrase (void) const;
 
+  /**
+   * \brief Set the ContentLength header field.
+   * \param contentLength the length of the message body in bytes.
+   */
+  void SetContentLength (uint32_t contentLength);
+
+  /**
+   * \brief Get the ContentLength header field.
+   * \return the length of the message body in bytes, 0 if the field is not set.
+   */
+  uint32_t GetContentLength (void) const;
+
+  /**
+   * \brief Set the ContentType header field.
+   * \param contentType the type of the object carried by the message.
+   */
+  void SetContentType (ContentType contentType);
+
+  /**
+   * \brief Get the ContentType header field.
+   * \return the type of the object carried by the message.
+   */
+  ContentType GetContentType (void) const;
+
+  /**
+   * \brief Set the NumOfInlineObjects header field.
+   * \param numOfInlineObjects the number of inline objects of the web page.
+   */
+  void SetNumOfInlineObjects (uint32_t numOfInlineObjects);
+
+  /**
+   * \brief Get the NumOfInlineObjects header field.
+   * \return the number of inline objects of the web page, 0 if the field is not set.
+   */
+  uint32_t GetNumOfInlineObjects (void) const;
+
+  /**
+   * \brief Get the string of a ContentType value.
+   * \param contentType the ContentType value.
+   * \return the string sent on the wire.
+   */
+  static const char *ContentTypeToString (ContentType contentType);
+
   /**
    * \brief Set the Header Field of the HTTP Message
    * \param headerFieldName the name of the header field.
@@ -128,10 +208,14 @@ public:
 
   /**
    * \brief Get the Header Field of the HTTP Message
+   *
+   * Prefer the typed getters for the known header fields, this
+   * method formats their value as a string.
+   *
    * \param headerFieldName the name of the header field.
    * \return the header field
    */
-  std::string GetHeaderField(std::string headerFieldName);
+  std::string GetHeaderField(std::string headerFieldName) const;
 
   /**
    * \brief Print some informations about the header.
@@ -148,11 +232,33 @@ public:
 
   /**
    * \brief Deserialize the header.
+   *
+   * The header is parsed in a single pass and never beyond the end of the
+   * buffer or MAX_HEADER_SIZE bytes. GetParseStatus tells why it failed.
+   *
    * \param start Buffer iterator.
-   * \return size of the header.
+   * \return number of bytes consumed, 0 if no complete header was parsed.
    */
   virtual uint32_t Deserialize (Buffer::Iterator start);
 
+  /**
+   * \brief Parse the header from a contiguous array of bytes.
+   *
+   * Works like Deserialize, for callers that reassemble a header from
+   * several segments.
+   *
+   * \param data the bytes.
+   * \param size number of bytes available.
+   * \return number of bytes consumed, 0 if no complete header was parsed.
+   */
+  uint32_t Parse (const uint8_t *data, uint32_t size);
+
+  /**
+   * \brief Get the result of the last Deserialize or Parse call.
+   * \return the parse status.
+   */
+  ParseStatus GetParseStatus (void) const;
+
   /**
    * \brief Get the serialized size of the header.
    * \return size.
@@ -163,6 +269,18 @@ public:
   virtual TypeId GetInstanceTypeId (void) const;
 
 private:
+  /**
+   * \brief Single-pass parser shared by Deserialize and Parse.
+   * \param reader bounded byte reader.
+   * \return the parse status.
+   */
+  template <typename Reader>
+  ParseStatus DoParse (Reader &reader);
+
+  /**
+   * \brief Status of the last Deserialize or Parse call.
+   */
+  ParseStatus m_parseStatus;
 
   bool   m_request;
 
@@ -192,14 +310,39 @@ private:
   std::string m_phrase;
 
   /**
-   * \brief Map for Header Fields.
+   * \brief Flags of the known header fields that are set.
+   */
+  enum FieldFlag
+  {
+    CONTENT_LENGTH_FIELD = 1,
+    CONTENT_TYPE_FIELD = 2,
+    NUM_OF_INLINE_OBJECTS_FIELD = 4
+  };
+
+  /**
+   * \brief Known header fields that are set (FieldFlag bits).
+   */
+  uint8_t m_fields;
+
+  /**
+   * \brief ContentLength header field.
+   */
+  uint32_t m_contentLength;
+
+  /**
+   * \brief ContentType header field.
+   */
+  ContentType m_contentType;
+
+  /**
+   * \brief NumOfInlineObjects header field.
    */
-  std::map<std::string, std::string> m_headerFieldMap;
+  uint32_t m_numOfInlineObjects;
 
   /**
-   * \brief Iterator for Map Header Fields.
+   * \brief Header fields not known by the traffic generator.
    */
-  std::map<std::string, std::string>::iterator m_headerFieldMapIt;
+  std::vector<std::pair<std::string, std::string> > m_otherFields;
 };
 
 }
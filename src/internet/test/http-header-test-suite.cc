@@ -0,0 +1,296 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 Saulo da Mata
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Saulo da Mata <damata.saulo@gmail.com>
+ */
+
+#include "ns3/test.h"
+#include "ns3/buffer.h"
+#include "ns3/http-header.h"
+#include <string>
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * \brief Parse a header from a string, embedded NULL bytes included.
+ * \param header the header to parse into.
+ * \param wire the bytes.
+ * \param size number of bytes parsed, the whole string by default.
+ * \return number of bytes consumed.
+ */
+uint32_t
+ParseString (HttpHeader &header, const std::string &wire, uint32_t size)
+{
+  return header.Parse (reinterpret_cast<const uint8_t *> (wire.data ()), size);
+}
+
+uint32_t
+ParseString (HttpHeader &header, const std::string &wire)
+{
+  return ParseString (header, wire, wire.size ());
+}
+
+/**
+ * \brief Serialize a header to a string.
+ * \param header the header.
+ * \return the bytes.
+ */
+std::string
+SerializeToString (const HttpHeader &header)
+{
+  Buffer buffer;
+  buffer.AddAtStart (header.GetSerializedSize ());
+  header.Serialize (buffer.Begin ());
+  std::string wire (buffer.GetSize (), '\0');
+  buffer.Begin ().Read (reinterpret_cast<uint8_t *> (&wire[0]), wire.size ());
+  return wire;
+}
+
+/**
+ * \brief Build the response header used by the tests.
+ * \return the header.
+ */
+HttpHeader
+MakeResponse (void)
+{
+  HttpHeader response;
+  response.SetRequest (false);
+  response.SetVersion ("HTTP/1.1");
+  response.SetStatusCode ("200");
+  response.SetPhrase ("OK");
+  response.SetContentLength (12345);
+  response.SetContentType (HttpHeader::MAIN_OBJECT);
+  response.SetNumOfInlineObjects (42);
+  response.SetHeaderField ("Server", "ns-3");
+  return response;
+}
+
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief HttpHeader serialization round trip, with known and unknown fields.
+ */
+class HttpHeaderRoundTripTestCase : public TestCase
+{
+public:
+  HttpHeaderRoundTripTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+HttpHeaderRoundTripTestCase::HttpHeaderRoundTripTestCase ()
+  : TestCase ("HttpHeader serialization round trip")
+{
+}
+
+void
+HttpHeaderRoundTripTestCase::DoRun (void)
+{
+  HttpHeader response = MakeResponse ();
+  std::string wire = SerializeToString (response);
+  NS_TEST_ASSERT_MSG_EQ (wire, std::string ("HTTP/1.1 200 OK\r\nContentLength: 12345\r\n"
+                                            "ContentType: main/object\r\nNumOfInlineObjects: 42\r\n"
+                                            "Server: ns-3\r\n\r\n") + '\0',
+                         "Unexpected wire format");
+
+  Buffer buffer;
+  buffer.AddAtStart (response.GetSerializedSize ());
+  response.Serialize (buffer.Begin ());
+  HttpHeader parsed;
+  NS_TEST_ASSERT_MSG_EQ (parsed.Deserialize (buffer.Begin ()), wire.size (), "Deserialize must consume the whole header");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetParseStatus (), HttpHeader::PARSE_OK, "Deserialize failed");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetRequest (), false, "Wrong message kind");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetStatusCode (), "200", "Wrong status code");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetPhrase (), "OK", "Wrong phrase");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetContentLength (), 12345, "Wrong ContentLength");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetContentType (), HttpHeader::MAIN_OBJECT, "Wrong ContentType");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetNumOfInlineObjects (), 42, "Wrong NumOfInlineObjects");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetHeaderField ("Server"), "ns-3", "Unknown field lost");
+
+  HttpHeader request;
+  request.SetRequest (true);
+  request.SetMethod ("GET");
+  request.SetUrl ("main/object/7");
+  request.SetVersion ("HTTP/1.1");
+  wire = SerializeToString (request);
+  NS_TEST_ASSERT_MSG_EQ (ParseString (parsed, wire), wire.size (), "Request not parsed");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetRequest (), true, "Wrong message kind");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetMethod (), "GET", "Wrong method");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetUrl (), "main/object/7", "Wrong URL");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief A header split at any byte is incomplete until its last byte.
+ */
+class HttpHeaderSplitTestCase : public TestCase
+{
+public:
+  HttpHeaderSplitTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+HttpHeaderSplitTestCase::HttpHeaderSplitTestCase ()
+  : TestCase ("HttpHeader split at every byte")
+{
+}
+
+void
+HttpHeaderSplitTestCase::DoRun (void)
+{
+  std::string wire = SerializeToString (MakeResponse ());
+  HttpHeader parsed;
+  for (uint32_t size = 0; size < wire.size (); size++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (ParseString (parsed, wire, size), 0, "Header parsed from " << size << " bytes");
+      NS_TEST_ASSERT_MSG_EQ (parsed.GetParseStatus (), HttpHeader::PARSE_INCOMPLETE,
+                             "Truncated header at " << size << " bytes not reported incomplete");
+    }
+
+  // Bytes of the body following the header are not consumed.
+  std::string message = wire + "body";
+  NS_TEST_ASSERT_MSG_EQ (ParseString (parsed, message), wire.size (), "Body consumed with the header");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetContentLength (), 12345, "Wrong ContentLength");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Oversized headers, over-long field names and malformed input.
+ */
+class HttpHeaderLimitsTestCase : public TestCase
+{
+public:
+  HttpHeaderLimitsTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+HttpHeaderLimitsTestCase::HttpHeaderLimitsTestCase ()
+  : TestCase ("HttpHeader size limits and malformed input")
+{
+}
+
+void
+HttpHeaderLimitsTestCase::DoRun (void)
+{
+  HttpHeader parsed;
+  const std::string start = "HTTP/1.1 200 OK\r\n";
+  const std::string end = std::string ("\r\n") + '\0';
+
+  // A field value running past MAX_HEADER_SIZE.
+  std::string large = start + "Padding: " + std::string (HttpHeader::MAX_HEADER_SIZE, 'x') + "\r\n" + end;
+  NS_TEST_ASSERT_MSG_EQ (ParseString (parsed, large), 0, "Oversized header parsed");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetParseStatus (), HttpHeader::PARSE_TOO_LARGE, "Oversized header not reported");
+
+  // Cut before MAX_HEADER_SIZE, the same header is only incomplete.
+  NS_TEST_ASSERT_MSG_EQ (ParseString (parsed, large, HttpHeader::MAX_HEADER_SIZE / 2), 0, "Truncated header parsed");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetParseStatus (), HttpHeader::PARSE_INCOMPLETE, "Truncated header not incomplete");
+
+  // Field names up to MAX_FIELD_NAME_SIZE bytes are accepted, longer ones are not.
+  std::string name (HttpHeader::MAX_FIELD_NAME_SIZE, 'n');
+  std::string wire = start + name + ": v\r\n" + end;
+  NS_TEST_ASSERT_MSG_EQ (ParseString (parsed, wire), wire.size (), "Longest field name rejected");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetHeaderField (name), "v", "Longest field name lost");
+  wire = start + name + "n: v\r\n" + end;
+  NS_TEST_ASSERT_MSG_EQ (ParseString (parsed, wire), 0, "Over-long field name accepted");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetParseStatus (), HttpHeader::PARSE_MALFORMED, "Over-long field name not malformed");
+
+  const char *malformed[] = {
+    "HTTP/1.1 200 OK\r\nContentLength: 12a\r\n\r\n",       // not a number
+    "HTTP/1.1 200 OK\r\nContentLength: \r\n\r\n",          // no digits
+    "HTTP/1.1 200 OK\r\nContentLength: 4294967296\r\n\r\n", // overflow
+    "HTTP/1.1 200 OK\r\nContentLength:5\r\n\r\n",          // no space after the colon
+    "HTTP/1.1 200 OK\r\nServer\r\n\r\n",                   // no colon
+    "HTTP/1.1 200 OK\nServer: ns-3\r\n\r\n",               // LF without CR
+    "HTTP/1.1 200\r\n\r\n",                                // no phrase
+    "HTTP/1.1 200 OK\r\n\r\nX",                            // no NULL byte
+  };
+  for (uint32_t i = 0; i < sizeof (malformed) / sizeof (malformed[0]); i++)
+    {
+      wire = std::string (malformed[i]) + '\0';
+      NS_TEST_ASSERT_MSG_EQ (ParseString (parsed, wire), 0, "Malformed header " << i << " parsed");
+      NS_TEST_ASSERT_MSG_EQ (parsed.GetParseStatus (), HttpHeader::PARSE_MALFORMED,
+                             "Malformed header " << i << " not reported malformed");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief A reused header does not keep the fields of the previous message.
+ */
+class HttpHeaderReuseTestCase : public TestCase
+{
+public:
+  HttpHeaderReuseTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+HttpHeaderReuseTestCase::HttpHeaderReuseTestCase ()
+  : TestCase ("HttpHeader reused for another message")
+{
+}
+
+void
+HttpHeaderReuseTestCase::DoRun (void)
+{
+  HttpHeader parsed;
+  std::string wire = SerializeToString (MakeResponse ());
+  NS_TEST_ASSERT_MSG_EQ (ParseString (parsed, wire), wire.size (), "First header not parsed");
+
+  wire = std::string ("HTTP/1.1 503 Service Unavailable\r\n\r\n") + '\0';
+  NS_TEST_ASSERT_MSG_EQ (ParseString (parsed, wire), wire.size (), "Second header not parsed");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetPhrase (), "Service Unavailable", "Wrong phrase");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetContentLength (), 0, "Stale ContentLength");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetContentType (), HttpHeader::NO_CONTENT_TYPE, "Stale ContentType");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetNumOfInlineObjects (), 0, "Stale NumOfInlineObjects");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetHeaderField ("Server"), "", "Stale unknown field");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief HttpHeader TestSuite
+ */
+class HttpHeaderTestSuite : public TestSuite
+{
+public:
+  HttpHeaderTestSuite ();
+};
+
+HttpHeaderTestSuite::HttpHeaderTestSuite ()
+  : TestSuite ("http-header", UNIT)
+{
+  AddTestCase (new HttpHeaderRoundTripTestCase, TestCase::QUICK);
+  AddTestCase (new HttpHeaderSplitTestCase, TestCase::QUICK);
+  AddTestCase (new HttpHeaderLimitsTestCase, TestCase::QUICK);
+  AddTestCase (new HttpHeaderReuseTestCase, TestCase::QUICK);
+}
+
+static HttpHeaderTestSuite g_httpHeaderTestSuite; //!< Static variable for test initialization